@@ -1,23 +1,10 @@
 #include <iostream>
 #include <vector>
 #include <iterator>
+#include "find_all.hpp"
 
-template <typename InputIterator, typename OutputIterator, typename Predicate>
-OutputIterator find_all(InputIterator first, InputIterator last, OutputIterator output, Predicate pred)
-{
-    while (first != last)
-    {
-        if (pred(*first))
-        {
-            *output = first;
-            ++output;
-        }
-        ++first;
-    }
-
-    return output;
-}
-
+// find_all lives in find_all.hpp, the overload taking an execution policy in find_all_parallel.hpp;
+// find_all_benchmark.cpp times them.
 int main()
 {
     using my_container = std::vector<int>;
@@ -32,4 +19,4 @@ int main()
         std::cout << *it << " at position " << (it - cbegin(values)) << std::endl;
     }
     return 0;
-}
\ No newline at end of file
+}
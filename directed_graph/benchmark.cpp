@@ -0,0 +1,516 @@
+// Benchmark driver for directed_graph.
+//
+//   g++ -std=c++20 -O2 -DNDEBUG benchmark.cpp -o benchmark -ltbb
+//   ./benchmark [--min-nodes N] [--max-nodes N] [--shape NAME] [--op NAME] [--repeat R] [--json FILE]
+//
+// Every operation is run on synthetic graphs of every shape (random, power_law, chain, dense)
+// and size (1K, 10K, ... up to --max-nodes, at most 10M). A table with ns/op, throughput and peak
+// RSS goes to stdout, the same results as JSON go to --json. Operations whose cost grows faster
+// than linearly are run on a bounded sample of nodes or skipped on large graphs, see run_shape.
+// Peak RSS is the process high-water mark after the operation, so it only ever grows within a run.
+// Before the parallel algorithms are timed their results are checked against the serial ones, a
+// mismatch ends the run with exit code 1.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <execution>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include "directed_graph.hpp"
+#include "graph_export.hpp"
+#include "graph_algorithms.hpp"
+
+using graph_type = directed_graph<int>;
+using edge_list = std::vector<std::pair<int, int>>;
+
+struct benchmark_options
+{
+    std::size_t min_nodes = 1000;
+    std::size_t max_nodes = 1000000;
+    std::string shape; // empty runs every shape
+    std::string op;    // empty runs every operation
+    int repeat = 3;
+    std::string json_path;
+    // graphs with more edges than this are skipped
+    std::size_t max_edges = 64000000;
+};
+
+struct benchmark_result
+{
+    std::string op;
+    std::string shape;
+    std::size_t nodes;
+    std::size_t edges;
+    std::size_t ops;
+    double ns_per_op;
+    double ops_per_sec;
+    long peak_rss_kb;
+};
+
+// keeps the compiler from dropping computations whose result is unused
+template <typename T>
+void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+long peak_rss_kb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // kilobytes on Linux
+}
+
+// Synthetic edge sets over the nodes 0 .. nodes - 1, seeded so runs are comparable.
+edge_list make_edges(std::string_view shape, std::size_t nodes)
+{
+    edge_list edges;
+    const int n = static_cast<int>(nodes);
+    std::mt19937_64 rng(42);
+    if (shape == "random")
+    {
+        // uniform targets, average out-degree 8
+        std::uniform_int_distribution<int> node(0, n - 1);
+        edges.reserve(nodes * 8);
+        for (int from = 0; from < n; ++from)
+            for (int k = 0; k < 8; ++k)
+                edges.emplace_back(from, node(rng));
+    }
+    else if (shape == "power_law")
+    {
+        // out-degree 8, targets skewed towards low indices so a few hubs collect most incoming edges
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        edges.reserve(nodes * 8);
+        for (int from = 0; from < n; ++from)
+            for (int k = 0; k < 8; ++k)
+                edges.emplace_back(from, std::min(n - 1, static_cast<int>(n * std::pow(unit(rng), 3.0))));
+    }
+    else if (shape == "chain")
+    {
+        edges.reserve(nodes);
+        for (int from = 0; from + 1 < n; ++from)
+            edges.emplace_back(from, from + 1);
+    }
+    else if (shape == "dense")
+    {
+        // every node points to the next min(n - 1, 1024) nodes, i.e. complete up to 1K nodes
+        const int degree = std::min(n - 1, 1024);
+        edges.reserve(nodes * static_cast<std::size_t>(degree));
+        for (int from = 0; from < n; ++from)
+            for (int k = 1; k <= degree; ++k)
+                edges.emplace_back(from, (from + k) % n);
+    }
+    return edges;
+}
+
+std::size_t expected_edges(std::string_view shape, std::size_t nodes)
+{
+    if (shape == "chain")
+        return nodes;
+    if (shape == "dense")
+        return nodes * std::min<std::size_t>(nodes - 1, 1024);
+    return nodes * 8;
+}
+
+// Whether both assign the nodes to the same components, whatever the component ids are.
+bool same_partition(const strong_components &lhs, const strong_components &rhs)
+{
+    if (lhs.count != rhs.count || lhs.component.size() != rhs.component.size())
+        return false;
+    std::vector<std::size_t> lhs_to_rhs(lhs.count, strong_components::npos);
+    for (std::size_t index = 0; index < lhs.component.size(); ++index)
+    {
+        const std::size_t id = lhs.component[index];
+        if (id == strong_components::npos || rhs.component[index] == strong_components::npos)
+        {
+            if (id != rhs.component[index])
+                return false;
+            continue;
+        }
+        if (lhs_to_rhs[id] == strong_components::npos)
+            lhs_to_rhs[id] = rhs.component[index];
+        else if (lhs_to_rhs[id] != rhs.component[index])
+            return false;
+    }
+    // and no two components of lhs may be one of rhs
+    std::vector<bool> used(rhs.count, false);
+    for (auto &&id : lhs_to_rhs)
+    {
+        if (id == strong_components::npos || used[id])
+            return false;
+        used[id] = true;
+    }
+    return true;
+}
+
+graph_type make_nodes(std::size_t nodes)
+{
+    graph_type graph;
+    for (int value = 0; value < static_cast<int>(nodes); ++value)
+        graph.insert(value);
+    return graph;
+}
+
+class benchmark_runner
+{
+public:
+    explicit benchmark_runner(const benchmark_options &options) : m_options(options) {}
+
+    void run_shape(const std::string &shape, std::size_t nodes);
+    const std::vector<benchmark_result> &results() const noexcept { return m_results; }
+
+private:
+    // Times body(graph) on a fresh copy of prototype, the copy itself is not timed.
+    // The best of --repeat runs is reported; body returns the number of operations it did.
+    void measure(const std::string &op, const graph_type &prototype, const std::function<std::size_t(graph_type &)> &body);
+    bool selected(std::string_view op) const { return m_options.op.empty() || m_options.op == op; }
+    // Ends the run if the parallel op disagreed with its serial counterpart, like sharded_benchmark does.
+    void check_consistency(std::string_view op, bool consistent) const;
+
+    const benchmark_options &m_options;
+    std::vector<benchmark_result> m_results;
+    // the configuration run_shape is currently measuring
+    std::string m_shape;
+    std::size_t m_nodes = 0;
+    std::size_t m_edges = 0;
+};
+
+void benchmark_runner::measure(const std::string &op, const graph_type &prototype, const std::function<std::size_t(graph_type &)> &body)
+{
+    if (!selected(op))
+        return;
+    double best_ns = 0;
+    std::size_t ops = 0;
+    for (int run = 0; run < std::max(m_options.repeat, 1); ++run)
+    {
+        graph_type graph(prototype);
+        const auto start = std::chrono::steady_clock::now();
+        ops = body(graph);
+        const auto stop = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        if (run == 0 || ns < best_ns)
+            best_ns = ns;
+    }
+    ops = std::max<std::size_t>(ops, 1);
+    const double ns_per_op = best_ns / static_cast<double>(ops);
+    m_results.push_back({op, m_shape, m_nodes, m_edges, ops, ns_per_op, ns_per_op > 0 ? 1e9 / ns_per_op : 0.0, peak_rss_kb()});
+
+    const auto &result = m_results.back();
+    std::cout << std::left << std::setw(16) << result.op << std::setw(11) << result.shape << std::right << std::setw(10) << result.nodes
+              << std::setw(12) << result.edges << std::setw(12) << result.ops << std::fixed << std::setprecision(1) << std::setw(14)
+              << result.ns_per_op << std::setprecision(0) << std::setw(16) << result.ops_per_sec << std::setw(12) << result.peak_rss_kb
+              << std::endl;
+}
+
+void benchmark_runner::check_consistency(std::string_view op, bool consistent) const
+{
+    if (consistent)
+        return;
+    std::cerr << op << ": result differs from the serial algorithm on " << m_shape << " with " << m_nodes << " nodes\n";
+    std::exit(1);
+}
+
+void benchmark_runner::run_shape(const std::string &shape, std::size_t nodes)
+{
+    if (expected_edges(shape, nodes) > m_options.max_edges)
+    {
+        std::cout << "skipping " << shape << " with " << nodes << " nodes, more than " << m_options.max_edges << " edges\n";
+        return;
+    }
+
+    const edge_list edges = make_edges(shape, nodes);
+    const graph_type empty;
+    const graph_type nodes_only = make_nodes(nodes);
+    graph_type full(nodes_only);
+    full.insert_edges(std::begin(edges), std::end(edges));
+    const std::size_t edge_count = full.edge_count();
+    m_shape = shape;
+    m_nodes = nodes;
+    m_edges = edge_count;
+
+    // sampled node values for the operations that are not run on every node
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> node(0, static_cast<int>(nodes) - 1);
+    const auto sample = [&](std::size_t count)
+    {
+        std::vector<int> values(std::min(count, nodes));
+        for (auto &&value : values)
+            value = node(rng);
+        return values;
+    };
+
+    measure("insert", empty, [nodes](graph_type &graph)
+            {
+        for (int value = 0; value < static_cast<int>(nodes); ++value)
+            graph.insert(value);
+        return nodes; });
+
+    measure("insert_edge", nodes_only, [&edges](graph_type &graph)
+            {
+        for (auto &&[from, to] : edges)
+            graph.insert_edge(from, to);
+        return edges.size(); });
+
+    measure("insert_edges", nodes_only, [&edges](graph_type &graph)
+            {
+        graph.insert_edges(std::begin(edges), std::end(edges));
+        return edges.size(); });
+
+    const std::size_t erase_edge_count = std::min<std::size_t>(edges.size(), 100000);
+    measure("erase_edge", full, [&edges, erase_edge_count](graph_type &graph)
+            {
+        for (std::size_t k = 0; k < erase_edge_count; ++k)
+            graph.erase_edge(edges[k].first, edges[k].second);
+        return erase_edge_count; });
+
+    // every single erase renumbers the whole graph, so only a handful are done
+    const auto erase_values = sample(nodes <= 100000 ? 100 : 10);
+    measure("erase", full, [&erase_values](graph_type &graph)
+            {
+        for (auto &&value : erase_values)
+        {
+            const auto pos = std::find(graph.cbegin(), graph.cend(), value);
+            if (pos != graph.cend())
+                graph.erase(pos);
+        }
+        return erase_values.size(); });
+
+    measure("erase_range", full, [nodes](graph_type &graph)
+            {
+        auto first = graph.cbegin();
+        std::advance(first, nodes * 45 / 100);
+        auto last = first;
+        std::advance(last, nodes / 10);
+        graph.erase(first, last);
+        return std::max<std::size_t>(nodes / 10, 1); });
+
+    // a tenth of the nodes, scattered over the whole graph, erased in one batch
+    const auto batch_values = sample(std::max<std::size_t>(nodes / 10, 1));
+    measure("erase_nodes", full, [&batch_values](graph_type &graph)
+            { return graph.erase_nodes(batch_values); });
+
+    measure("erase_if", full, [](graph_type &graph)
+            { return erase_if(graph, [](int value)
+                              { return value % 10 == 0; }); });
+
+    // std::find is linear, keep the total work around 10^8 node visits
+    const auto find_values = sample(std::clamp<std::size_t>(100000000 / nodes, 10, 10000));
+    measure("std_find", full, [&find_values](graph_type &graph)
+            {
+        std::size_t found = 0;
+        for (auto &&value : find_values)
+            found += std::find(std::cbegin(graph), std::cend(graph), value) != std::cend(graph);
+        do_not_optimize(found);
+        return find_values.size(); });
+
+    measure("iterate", full, [](graph_type &graph)
+            {
+        long long sum = 0;
+        for (auto &&value : std::as_const(graph))
+            sum += value;
+        do_not_optimize(sum);
+        return graph.size(); });
+
+    const auto adjacency_values = sample(100000);
+    measure("adjacency", full, [&adjacency_values](graph_type &graph)
+            {
+        std::size_t visited = 0;
+        long long sum = 0;
+        for (auto &&value : adjacency_values)
+        {
+            for (auto &&adjacent : graph.neighbors(value))
+            {
+                sum += adjacent;
+                ++visited;
+            }
+        }
+        do_not_optimize(sum);
+        return visited; });
+
+    // visited edges per second, Tarjan against the trimming parallel search
+    measure("scc", full, [edge_count](graph_type &graph)
+            {
+        const auto components = strongly_connected_components(graph);
+        do_not_optimize(components);
+        return std::max<std::size_t>(edge_count, 1); });
+
+    if (selected("scc_parallel"))
+    {
+        check_consistency("scc_parallel", same_partition(strongly_connected_components(std::execution::par, full), strongly_connected_components(full)));
+        measure("scc_parallel", full, [edge_count](graph_type &graph)
+                {
+            const auto components = strongly_connected_components(std::execution::par, graph);
+            do_not_optimize(components);
+            return std::max<std::size_t>(edge_count, 1); });
+    }
+
+    // reached edges per second, sequential top-down against the parallel direction-optimizing search
+    measure("bfs", full, [edge_count](graph_type &graph)
+            {
+        const auto tree = breadth_first_search(graph, 0);
+        do_not_optimize(tree);
+        return std::max<std::size_t>(edge_count, 1); });
+
+    // parents may differ between equally short paths, the distances may not
+    const auto bfs_distances = [&full]
+    { return breadth_first_search(full, 0).distance; };
+    if (selected("bfs_parallel"))
+    {
+        check_consistency("bfs_parallel", breadth_first_search(std::execution::par, full, 0).distance == bfs_distances());
+        measure("bfs_parallel", full, [edge_count](graph_type &graph)
+                {
+            const auto tree = breadth_first_search(std::execution::par, graph, 0);
+            do_not_optimize(tree);
+            return std::max<std::size_t>(edge_count, 1); });
+    }
+
+    // the same search with the reversed edges built beforehand, as for repeated queries
+    if (selected("bfs_engine"))
+    {
+        const bfs_engine<graph_type> engine(full);
+        check_consistency("bfs_engine", engine.search(std::execution::par, 0).distance == bfs_distances());
+        measure("bfs_engine", full, [&engine, edge_count](graph_type &)
+                {
+            const auto tree = engine.search(std::execution::par, 0);
+            do_not_optimize(tree);
+            return std::max<std::size_t>(edge_count, 1); });
+    }
+
+    // shortest paths with every edge of length 1, the same work as bfs plus the queue
+    measure("dijkstra", full, [edge_count](graph_type &graph)
+            {
+        const auto tree = dijkstra(graph, 0);
+        do_not_optimize(tree);
+        return std::max<std::size_t>(edge_count, 1); });
+
+    if (selected("delta_stepping"))
+    {
+        // the lengths are integers, so the distances must match exactly
+        check_consistency("delta_stepping", delta_stepping(std::execution::par, full, 0).distance == dijkstra(full, 0).distance);
+        measure("delta_stepping", full, [edge_count](graph_type &graph)
+                {
+            const auto tree = delta_stepping(std::execution::par, graph, 0);
+            do_not_optimize(tree);
+            return std::max<std::size_t>(edge_count, 1); });
+    }
+
+    measure("operator==", full, [&full](graph_type &graph)
+            {
+        const bool equal = graph == full;
+        do_not_optimize(equal);
+        return std::size_t{1}; });
+
+    std::vector<int> values(nodes);
+    for (std::size_t index = 0; index < nodes; ++index)
+        values[index] = static_cast<int>(nodes - index);
+    measure("assign", full, [&values](graph_type &graph)
+            {
+        graph.assign(std::begin(values), std::end(values));
+        return values.size(); });
+    if (selected("assign_parallel"))
+    {
+        graph_type serial;
+        serial.assign(std::begin(values), std::end(values));
+        graph_type parallel;
+        parallel.assign(std::execution::par, std::begin(values), std::end(values));
+        check_consistency("assign_parallel", parallel == serial && std::equal(std::cbegin(parallel), std::cend(parallel), std::cbegin(serial)));
+        measure("assign_parallel", full, [&values](graph_type &graph)
+                {
+            graph.assign(std::execution::par, std::begin(values), std::end(values));
+            return values.size(); });
+    }
+
+    measure("to_dot", full, [edge_count](graph_type &graph)
+            {
+        std::size_t bytes = 0;
+        export_graph(graph, [&bytes](std::string_view text)
+                     { bytes += text.size(); }, {export_format::dot, "bench"});
+        do_not_optimize(bytes);
+        return std::max<std::size_t>(edge_count, 1); });
+}
+
+void write_json(const std::vector<benchmark_result> &results, std::ostream &out)
+{
+    out << "{\n  \"benchmark\": \"directed_graph\",\n  \"results\": [";
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        const auto &result = results[index];
+        out << (index == 0 ? "\n" : ",\n") << "    {\"op\": \"" << result.op << "\", \"shape\": \"" << result.shape
+            << "\", \"nodes\": " << result.nodes << ", \"edges\": " << result.edges << ", \"ops\": " << result.ops
+            << std::setprecision(6) << std::defaultfloat << ", \"ns_per_op\": " << result.ns_per_op << ", \"ops_per_sec\": "
+            << result.ops_per_sec << ", \"peak_rss_kb\": " << result.peak_rss_kb << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int usage(const char *program)
+{
+    std::cerr << "usage: " << program
+              << " [--min-nodes N] [--max-nodes N] [--shape random|power_law|chain|dense] [--op NAME] [--repeat R] [--json FILE]\n";
+    return 2;
+}
+
+// Driver code
+int main(int argc, char *argv[])
+{
+    benchmark_options options;
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string_view arg = argv[index];
+        if (index + 1 >= argc)
+            return usage(argv[0]);
+        const char *value = argv[++index];
+        if (arg == "--min-nodes")
+            options.min_nodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--max-nodes")
+            options.max_nodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--shape")
+            options.shape = value;
+        else if (arg == "--op")
+            options.op = value;
+        else if (arg == "--repeat")
+            options.repeat = std::atoi(value);
+        else if (arg == "--json")
+            options.json_path = value;
+        else
+            return usage(argv[0]);
+    }
+
+    std::cout << std::left << std::setw(16) << "op" << std::setw(11) << "shape" << std::right << std::setw(10) << "nodes"
+              << std::setw(12) << "edges" << std::setw(12) << "ops" << std::setw(14) << "ns/op" << std::setw(16) << "ops/s"
+              << std::setw(12) << "rss_kb" << std::endl;
+
+    benchmark_runner runner(options);
+    for (const std::string shape : {"random", "power_law", "chain", "dense"})
+    {
+        if (!options.shape.empty() && options.shape != shape)
+            continue;
+        for (std::size_t nodes = 1000; nodes <= std::min<std::size_t>(options.max_nodes, 10000000); nodes *= 10)
+        {
+            if (nodes >= options.min_nodes)
+                runner.run_shape(shape, nodes);
+        }
+    }
+
+    if (!options.json_path.empty())
+    {
+        std::ofstream json(options.json_path);
+        write_json(runner.results(), json);
+        if (!json)
+        {
+            std::cerr << "cannot write " << options.json_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,326 @@
+#ifndef BITSET_ADJACENCY_HPP
+#define BITSET_ADJACENCY_HPP
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Adjacency list that stores one bit per possible target, for dense graphs in directed_graph, see
+// dense_directed_graph. The lists of all nodes together form a row-major adjacency matrix; a row
+// only grows up to the word holding its largest target, so it never takes more than V / 8 bytes.
+// Testing, inserting and erasing an edge are O(1), iteration scans the row a word at a time with
+// countr_zero and yields the targets in ascending order like a set.
+// The set operations work a word at a time in branch-free loops the compiler turns into SIMD code.
+// Unlike std::set, inserting may invalidate iterators into the list.
+class bitset_adjacency
+{
+public:
+    using key_type = std::size_t;
+    using value_type = std::size_t;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    // targets are computed from the bits, iterators hand them out by value
+    using reference = value_type;
+    using const_reference = value_type;
+    using word_type = std::uint64_t;
+    static constexpr size_type word_bits = std::numeric_limits<word_type>::digits;
+
+    // Bidirectional iterator over the set bits of a row.
+    class const_iterator
+    {
+    public:
+        using iterator_concept = std::bidirectional_iterator_tag;
+        // operator* returns a value, so for the classic iterator requirements it is an input iterator
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::size_t;
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept { return m_key; }
+
+        const_iterator &operator++() noexcept;
+        const_iterator operator++(int) noexcept;
+        const_iterator &operator--() noexcept;
+        const_iterator operator--(int) noexcept;
+
+        bool operator==(const const_iterator &rhs) const noexcept { return m_key == rhs.m_key; }
+
+    private:
+        friend class bitset_adjacency;
+        const_iterator(const bitset_adjacency *row, std::size_t key) noexcept : m_row(row), m_key(key) {}
+
+        const bitset_adjacency *m_row = nullptr;
+        std::size_t m_key = 0;
+    };
+    // keys are immutable through iterators, just like std::set
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    bitset_adjacency() = default;
+
+    const_iterator begin() const noexcept { return const_iterator(this, next_set(0)); }
+    const_iterator end() const noexcept { return const_iterator(this, end_key()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    size_type size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+    size_type max_size() const noexcept { return m_words.max_size(); }
+
+    std::pair<iterator, bool> insert(const key_type &key);
+    // the hint is not needed, every position is found in O(1)
+    iterator insert(const_iterator hint, const key_type &key);
+
+    iterator erase(const_iterator pos);
+    size_type erase(const key_type &key);
+
+    const_iterator find(const key_type &key) const noexcept { return contains(key) ? const_iterator(this, key) : end(); }
+    const_iterator lower_bound(const key_type &key) const noexcept { return const_iterator(this, next_set(key)); }
+    size_type count(const key_type &key) const noexcept { return contains(key) ? 1 : 0; }
+    bool contains(const key_type &key) const noexcept;
+
+    // Adds the targets set in other.
+    bitset_adjacency &operator|=(const bitset_adjacency &other);
+    // Keeps only the targets that are also set in other.
+    bitset_adjacency &operator&=(const bitset_adjacency &other) noexcept;
+    // Number of targets set in both rows, without building the intersection.
+    size_type intersection_size(const bitset_adjacency &other) const noexcept;
+
+    void clear() noexcept;
+    // Drops the words above the largest target.
+    void shrink_to_fit();
+
+    // Replaces the contents by the keys in [first, last), which must be sorted and unique.
+    template <typename Iter>
+    void assign_sorted_unique(Iter first, Iter last);
+    // Inserts the projected keys of [first, last), returns the number of new keys.
+    template <typename Iter, typename Projection = std::identity>
+    size_type merge_sorted_unique(Iter first, Iter last, Projection proj = {});
+    // Erases removed_key and decrements every larger key, one shift over the row.
+    void remove_and_renumber(const key_type &removed_key);
+
+    void swap(bitset_adjacency &other) noexcept;
+
+    // Trailing zero words do not matter.
+    bool operator==(const bitset_adjacency &rhs) const noexcept;
+    bool operator!=(const bitset_adjacency &rhs) const noexcept { return !(*this == rhs); }
+
+private:
+    std::vector<word_type> m_words;
+    size_type m_size = 0;
+
+    size_type end_key() const noexcept { return m_words.size() * word_bits; }
+    // First set bit at or after key, end_key() if there is none.
+    size_type next_set(size_type key) const noexcept;
+    // Last set bit before key, which must exist.
+    size_type previous_set(size_type key) const noexcept;
+    static size_type count_bits(const std::vector<word_type> &words) noexcept;
+};
+
+inline bitset_adjacency::const_iterator &bitset_adjacency::const_iterator::operator++() noexcept
+{
+    m_key = m_row->next_set(m_key + 1);
+    return *this;
+}
+
+inline bitset_adjacency::const_iterator bitset_adjacency::const_iterator::operator++(int) noexcept
+{
+    auto oldIt = *this;
+    ++*this;
+    return oldIt;
+}
+
+inline bitset_adjacency::const_iterator &bitset_adjacency::const_iterator::operator--() noexcept
+{
+    m_key = m_row->previous_set(m_key);
+    return *this;
+}
+
+inline bitset_adjacency::const_iterator bitset_adjacency::const_iterator::operator--(int) noexcept
+{
+    auto oldIt = *this;
+    --*this;
+    return oldIt;
+}
+
+inline bitset_adjacency::size_type bitset_adjacency::next_set(size_type key) const noexcept
+{
+    size_type word = key / word_bits;
+    if (word >= m_words.size())
+        return end_key();
+    // mask off the bits below key in its word, then skip the empty words
+    word_type bits = m_words[word] & (~word_type{0} << (key % word_bits));
+    while (bits == 0)
+    {
+        if (++word == m_words.size())
+            return end_key();
+        bits = m_words[word];
+    }
+    return word * word_bits + static_cast<size_type>(std::countr_zero(bits));
+}
+
+inline bitset_adjacency::size_type bitset_adjacency::previous_set(size_type key) const noexcept
+{
+    size_type word = key / word_bits;
+    // keep the bits below key in its word, key may be end_key() and then names no word at all
+    word_type bits = word < m_words.size() && key % word_bits != 0 ? m_words[word] & (~word_type{0} >> (word_bits - key % word_bits)) : 0;
+    while (bits == 0)
+        bits = m_words[--word];
+    return word * word_bits + (word_bits - 1 - static_cast<size_type>(std::countl_zero(bits)));
+}
+
+inline bitset_adjacency::size_type bitset_adjacency::count_bits(const std::vector<word_type> &words) noexcept
+{
+    size_type count = 0;
+    for (auto &&word : words)
+        count += static_cast<size_type>(std::popcount(word));
+    return count;
+}
+
+inline bool bitset_adjacency::contains(const key_type &key) const noexcept
+{
+    const size_type word = key / word_bits;
+    return word < m_words.size() && (m_words[word] >> (key % word_bits) & 1) != 0;
+}
+
+inline std::pair<bitset_adjacency::iterator, bool> bitset_adjacency::insert(const key_type &key)
+{
+    const size_type word = key / word_bits;
+    if (word >= m_words.size())
+        m_words.resize(word + 1);
+    const word_type bit = word_type{1} << (key % word_bits);
+    const bool inserted = (m_words[word] & bit) == 0;
+    m_words[word] |= bit;
+    m_size += inserted ? 1 : 0;
+    return {const_iterator(this, key), inserted};
+}
+
+inline bitset_adjacency::iterator bitset_adjacency::insert(const_iterator, const key_type &key)
+{
+    return insert(key).first;
+}
+
+inline bitset_adjacency::iterator bitset_adjacency::erase(const_iterator pos)
+{
+    erase(*pos);
+    return const_iterator(this, next_set(*pos + 1));
+}
+
+inline bitset_adjacency::size_type bitset_adjacency::erase(const key_type &key)
+{
+    if (!contains(key))
+        return 0;
+    m_words[key / word_bits] &= ~(word_type{1} << (key % word_bits));
+    --m_size;
+    return 1;
+}
+
+inline bitset_adjacency &bitset_adjacency::operator|=(const bitset_adjacency &other)
+{
+    if (other.m_words.size() > m_words.size())
+        m_words.resize(other.m_words.size());
+    const word_type *source = other.m_words.data();
+    word_type *target = m_words.data();
+    for (size_type word = 0; word < other.m_words.size(); ++word)
+        target[word] |= source[word];
+    m_size = count_bits(m_words);
+    return *this;
+}
+
+inline bitset_adjacency &bitset_adjacency::operator&=(const bitset_adjacency &other) noexcept
+{
+    const size_type common = std::min(m_words.size(), other.m_words.size());
+    const word_type *source = other.m_words.data();
+    word_type *target = m_words.data();
+    for (size_type word = 0; word < common; ++word)
+        target[word] &= source[word];
+    std::fill(std::begin(m_words) + static_cast<difference_type>(common), std::end(m_words), word_type{0});
+    m_size = count_bits(m_words);
+    return *this;
+}
+
+inline bitset_adjacency::size_type bitset_adjacency::intersection_size(const bitset_adjacency &other) const noexcept
+{
+    const size_type common = std::min(m_words.size(), other.m_words.size());
+    const word_type *lhs = m_words.data();
+    const word_type *rhs = other.m_words.data();
+    size_type count = 0;
+    for (size_type word = 0; word < common; ++word)
+        count += static_cast<size_type>(std::popcount(lhs[word] & rhs[word]));
+    return count;
+}
+
+inline void bitset_adjacency::clear() noexcept
+{
+    m_words.clear();
+    m_size = 0;
+}
+
+inline void bitset_adjacency::shrink_to_fit()
+{
+    while (!m_words.empty() && m_words.back() == 0)
+        m_words.pop_back();
+    m_words.shrink_to_fit();
+}
+
+template <typename Iter>
+void bitset_adjacency::assign_sorted_unique(Iter first, Iter last)
+{
+    clear();
+    for (; first != last; ++first)
+        insert(static_cast<key_type>(*first));
+}
+
+template <typename Iter, typename Projection>
+bitset_adjacency::size_type bitset_adjacency::merge_sorted_unique(Iter first, Iter last, Projection proj)
+{
+    const size_type old_size = m_size;
+    for (; first != last; ++first)
+        insert(static_cast<key_type>(std::invoke(proj, *first)));
+    return m_size - old_size;
+}
+
+inline void bitset_adjacency::remove_and_renumber(const key_type &removed_key)
+{
+    const size_type word = removed_key / word_bits;
+    if (word >= m_words.size())
+        return;
+    erase(removed_key);
+    // shift everything above removed_key down by one bit, carrying across the word boundaries
+    const word_type below = (word_type{1} << (removed_key % word_bits)) - 1;
+    m_words[word] = (m_words[word] & below) | ((m_words[word] >> 1) & ~below);
+    for (size_type next = word + 1; next < m_words.size(); ++next)
+    {
+        m_words[next - 1] |= m_words[next] << (word_bits - 1);
+        m_words[next] >>= 1;
+    }
+}
+
+inline void bitset_adjacency::swap(bitset_adjacency &other) noexcept
+{
+    m_words.swap(other.m_words);
+    std::swap(m_size, other.m_size);
+}
+
+inline bool bitset_adjacency::operator==(const bitset_adjacency &rhs) const noexcept
+{
+    if (m_size != rhs.m_size)
+        return false;
+    const size_type common = std::min(m_words.size(), rhs.m_words.size());
+    // equal counts and equal common words leave no set bits beyond them
+    return std::equal(std::begin(m_words), std::begin(m_words) + static_cast<difference_type>(common), std::begin(rhs.m_words));
+}
+#endif
@@ -1,7 +1,8 @@
 #ifndef CONST_ADJACENT_NODES_ITERATOR_HPP
 #define CONST_ADJACENT_NODES_ITERATOR_HPP
+#include <cstddef>
 #include <iterator>
-#include <set>
+#include <type_traits>
 
 template <typename DirectedGraph>
 class const_adjacent_nodes_iterator
@@ -9,20 +10,29 @@ class const_adjacent_nodes_iterator
 public:
     using value_type = typename DirectedGraph::value_type;
     using difference_type = ptrdiff_t;
-    using iterator_category = std::bidirectional_iterator_tag;
     using pointer = const value_type *;
-    using reference = const value_type &;
-    using iterator_type = typename std::set<value_type>::const_iterator;
+    // Graphs that hand out values by proxy (e.g. std::string_view) make this an input iterator.
+    using reference = typename DirectedGraph::const_reference;
+    using iterator_category = std::conditional_t<std::is_reference_v<reference>, std::bidirectional_iterator_tag, std::input_iterator_tag>;
+    // Walks the adjacency indices of a node and resolves them to values through the graph.
+    using iterator_type = typename DirectedGraph::adjacency_list_type::const_iterator;
 
     // Bidirectional iterators must supply a default constructor
     // shoulld return an end iterator if the node value is not found
-    const_adjacent_nodes_iterator();
+    const_adjacent_nodes_iterator() = default;
     // no transfer of ownership of graph
     // shoulld return an end iterator if the node value is not found
+    // Only for graphs without tombstoned nodes, e.g. csr_graph.
     const_adjacent_nodes_iterator(iterator_type it, const DirectedGraph *graph);
+    // For graphs with tombstoned nodes: it .. last is the rest of the adjacency list,
+    // entries naming tombstoned nodes are skipped.
+    const_adjacent_nodes_iterator(iterator_type it, iterator_type last, const DirectedGraph *graph);
 
     reference operator*() const;
     pointer operator->() const;
+    // The property of the current edge, for adjacency lists that keep one (see weighted_adjacency).
+    decltype(auto) edge_property() const
+        requires requires(iterator_type it) { it.property(); };
 
     const_adjacent_nodes_iterator &operator++();
     const_adjacent_nodes_iterator operator++(int);
@@ -36,9 +46,13 @@ public:
     bool operator!=(const const_adjacent_nodes_iterator &rhs) const;
 
 public:
-    iterator_type m_nodeIterator;
+    iterator_type m_nodeIterator{};
+    iterator_type m_lastIterator{};
     const DirectedGraph *m_graph = nullptr;
 
+    static constexpr bool skips_erased = requires(const DirectedGraph &graph, std::size_t index) { graph.is_erased(index); };
+    bool is_erased() const;
+
     // Helper methods for operator++ and operator--
     void increment();
     void decrement();
@@ -47,18 +61,29 @@ public:
 // const_directed_graph_members implementation
 
 template <typename DirectedGraph>
-const_adjacent_nodes_iterator<DirectedGraph>::const_adjacent_nodes_iterator()
+const_adjacent_nodes_iterator<DirectedGraph>::const_adjacent_nodes_iterator(iterator_type it, const DirectedGraph *graph) : m_nodeIterator(it), m_graph(graph) {}
+
+template <typename DirectedGraph>
+const_adjacent_nodes_iterator<DirectedGraph>::const_adjacent_nodes_iterator(iterator_type it, iterator_type last, const DirectedGraph *graph)
+    : m_nodeIterator(it), m_lastIterator(last), m_graph(graph)
 {
-    m_nodeIterator = std::set<value_type>::end(); // return default constructed iterator as end iterator for no node value found
+    while (m_nodeIterator != m_lastIterator && is_erased())
+        ++m_nodeIterator;
 }
 
 template <typename DirectedGraph>
-const_adjacent_nodes_iterator<DirectedGraph>::const_adjacent_nodes_iterator(iterator_type it, const DirectedGraph *graph) : m_nodeIterator(it), m_graph(graph) {}
+bool const_adjacent_nodes_iterator<DirectedGraph>::is_erased() const
+{
+    if constexpr (skips_erased)
+        return m_graph->is_erased(*m_nodeIterator);
+    else
+        return false;
+}
 
 template <typename DirectedGraph>
 typename const_adjacent_nodes_iterator<DirectedGraph>::reference const_adjacent_nodes_iterator<DirectedGraph>::operator*() const
 {
-    return m_nodeIterator->get();
+    return (*m_graph)[*m_nodeIterator];
 }
 
 // Return a pointer to the actual element, so the compiler can
@@ -66,7 +91,14 @@ typename const_adjacent_nodes_iterator<DirectedGraph>::reference const_adjacent_
 template <typename DirectedGraph>
 typename const_adjacent_nodes_iterator<DirectedGraph>::pointer const_adjacent_nodes_iterator<DirectedGraph>::operator->() const
 {
-    return &(m_nodeIterator->get());
+    return &((*m_graph)[*m_nodeIterator]);
+}
+
+template <typename DirectedGraph>
+decltype(auto) const_adjacent_nodes_iterator<DirectedGraph>::edge_property() const
+    requires requires(iterator_type it) { it.property(); }
+{
+    return m_nodeIterator.property();
 }
 
 template <typename DirectedGraph>
@@ -88,12 +120,22 @@ template <typename DirectedGraph>
 void const_adjacent_nodes_iterator<DirectedGraph>::increment()
 {
     ++m_nodeIterator;
+    if constexpr (skips_erased)
+    {
+        while (m_nodeIterator != m_lastIterator && is_erased())
+            ++m_nodeIterator;
+    }
 }
 
 template <typename DirectedGraph>
 void const_adjacent_nodes_iterator<DirectedGraph>::decrement()
 {
     --m_nodeIterator;
+    if constexpr (skips_erased)
+    {
+        while (is_erased())
+            --m_nodeIterator;
+    }
 }
 
 template <typename DirectedGraph>
@@ -78,13 +78,20 @@ const_directed_graph_iterator<DirectedGraph> const_directed_graph_iterator<Direc
 template <typename DirectedGraph>
 void const_directed_graph_iterator<DirectedGraph>::increment()
 {
-    ++m_nodeIterator;
+    // skip nodes tombstoned by a deferred erase
+    do
+    {
+        ++m_nodeIterator;
+    } while (m_graph->is_erased(m_nodeIterator));
 }
 
 template <typename DirectedGraph>
 void const_directed_graph_iterator<DirectedGraph>::decrement()
 {
-    --m_nodeIterator;
+    do
+    {
+        --m_nodeIterator;
+    } while (m_graph->is_erased(m_nodeIterator));
 }
 
 template <typename DirectedGraph>
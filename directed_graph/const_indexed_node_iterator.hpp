@@ -0,0 +1,93 @@
+#ifndef CONST_INDEXED_NODE_ITERATOR_HPP
+#define CONST_INDEXED_NODE_ITERATOR_HPP
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Iterates over the nodes of a graph by index and resolves each one through the graph's operator[].
+// Used by graphs that do not keep their values in a container of their own, e.g. mapped_graph.
+template <typename Graph>
+class const_indexed_node_iterator
+{
+public:
+    using value_type = typename Graph::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = typename Graph::const_reference;
+    using iterator_category = std::conditional_t<std::is_reference_v<reference>, std::bidirectional_iterator_tag, std::input_iterator_tag>;
+
+    // Bidirectional iterators must supply a default constructor
+    const_indexed_node_iterator() = default;
+    // no transfer of ownership of graph
+    const_indexed_node_iterator(std::size_t index, const Graph *graph);
+
+    reference operator*() const;
+
+    const_indexed_node_iterator &operator++();
+    const_indexed_node_iterator operator++(int);
+
+    const_indexed_node_iterator &operator--();
+    const_indexed_node_iterator operator--(int);
+
+    // The following are ok as member functions because we dont support
+    // comparisons of different types to this one.
+    bool operator==(const const_indexed_node_iterator &rhs) const;
+    bool operator!=(const const_indexed_node_iterator &rhs) const;
+
+public:
+    std::size_t m_index = 0;
+    const Graph *m_graph = nullptr;
+};
+
+template <typename Graph>
+const_indexed_node_iterator<Graph>::const_indexed_node_iterator(std::size_t index, const Graph *graph) : m_index(index), m_graph(graph) {}
+
+template <typename Graph>
+typename const_indexed_node_iterator<Graph>::reference const_indexed_node_iterator<Graph>::operator*() const
+{
+    return (*m_graph)[m_index];
+}
+
+template <typename Graph>
+const_indexed_node_iterator<Graph> &const_indexed_node_iterator<Graph>::operator++()
+{
+    ++m_index;
+    return *this;
+}
+
+template <typename Graph>
+const_indexed_node_iterator<Graph> const_indexed_node_iterator<Graph>::operator++(int)
+{
+    auto oldIt = *this;
+    ++m_index;
+    return oldIt;
+}
+
+template <typename Graph>
+const_indexed_node_iterator<Graph> &const_indexed_node_iterator<Graph>::operator--()
+{
+    --m_index;
+    return *this;
+}
+
+template <typename Graph>
+const_indexed_node_iterator<Graph> const_indexed_node_iterator<Graph>::operator--(int)
+{
+    auto oldIt = *this;
+    --m_index;
+    return oldIt;
+}
+
+template <typename Graph>
+bool const_indexed_node_iterator<Graph>::operator==(const const_indexed_node_iterator &rhs) const
+{
+    return m_index == rhs.m_index;
+}
+
+template <typename Graph>
+bool const_indexed_node_iterator<Graph>::operator!=(const const_indexed_node_iterator &rhs) const
+{
+    return m_index != rhs.m_index;
+}
+
+#endif
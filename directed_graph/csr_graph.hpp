@@ -0,0 +1,413 @@
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <type_traits>
+#include "node_index.hpp"
+#include "const_adjacent_nodes_iterator.hpp"
+
+// Contiguous view over the adjacency indices of one node of a csr_graph.
+class csr_adjacency_list
+{
+public:
+    using value_type = std::size_t;
+    using const_iterator = const std::size_t *;
+    using iterator = const_iterator;
+
+    csr_adjacency_list() = default;
+    csr_adjacency_list(const_iterator first, const_iterator last) noexcept : m_first(first), m_last(last) {}
+
+    const_iterator begin() const noexcept { return m_first; }
+    const_iterator end() const noexcept { return m_last; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(m_last - m_first); }
+    bool empty() const noexcept { return m_first == m_last; }
+
+private:
+    const_iterator m_first = nullptr;
+    const_iterator m_last = nullptr;
+};
+
+// Immutable compressed-sparse-row snapshot of a directed_graph, see directed_graph::freeze().
+// Node values, per-node edge offsets and the sorted edge targets are each stored in one
+// contiguous array, so traversals are sequential scans. Node indices match the source graph
+// once it has been compacted.
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+class csr_graph
+{
+public:
+    using values_container_type = std::vector<T>;
+    values_container_type m_values;
+    // m_offsets[i] .. m_offsets[i + 1] delimits the targets of node i in m_targets
+    std::vector<std::size_t> m_offsets{0};
+    std::vector<std::size_t> m_targets;
+
+    static constexpr bool has_node_index = !std::is_void_v<Hash>;
+    using node_index_type = node_index_t<T, Hash, KeyEqual>;
+    [[no_unique_address]] node_index_type m_nodeIndex;
+    // what m_nodeIndex compares lookups with
+    auto value_at() const noexcept
+    {
+        return [this](std::size_t index) -> const T & { return m_values[index]; };
+    }
+
+    typename values_container_type::const_iterator find(const T &node_value) const;
+
+public:
+    // public type aliases
+    using value_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = const value_type &;
+    using const_reference = const value_type &;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using adjacency_list_type = csr_adjacency_list;
+
+    // public iterator-related type aliases, the snapshot is read-only
+    using iterator = typename values_container_type::const_iterator;
+    using const_iterator = typename values_container_type::const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using const_iterator_adjacent_nodes = const_adjacent_nodes_iterator<csr_graph>;
+    using iterator_adjacent_nodes = const_iterator_adjacent_nodes;
+    using const_reverse_iterator_adjacent_nodes = std::reverse_iterator<const_iterator_adjacent_nodes>;
+    using reverse_iterator_adjacent_nodes = const_reverse_iterator_adjacent_nodes;
+    using adjacent_nodes_view = std::ranges::subrange<const_iterator_adjacent_nodes>;
+
+    csr_graph() = default;
+    // Builds the snapshot in one pass over the nodes of the given graph.
+    template <typename DirectedGraph>
+    explicit csr_graph(const DirectedGraph &graph);
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_reverse_iterator crbegin() const noexcept;
+    const_reverse_iterator crend() const noexcept;
+
+    // return iterator to the list of adjacent nodes for the given node
+    // return a default constructed iterator as the end iterator if the value is not found
+    const_iterator_adjacent_nodes begin(const T &node_value) const noexcept;
+    const_iterator_adjacent_nodes end(const T &node_value) const noexcept;
+    const_iterator_adjacent_nodes cbegin(const T &node_value) const noexcept;
+    const_iterator_adjacent_nodes cend(const T &node_value) const noexcept;
+
+    const_reverse_iterator_adjacent_nodes rbegin(const T &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes rend(const T &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes crbegin(const T &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes crend(const T &node_value) const noexcept;
+
+    const_reference operator[](size_type index) const;
+    const_reference at(size_type index) const;
+
+    // Sorted adjacency indices of the node at the given index.
+    adjacency_list_type get_adjacent_node_indices(size_type index) const noexcept;
+
+    // Same semantics as directed_graph::operator==
+    bool operator==(const csr_graph &rhs) const;
+    bool operator!=(const csr_graph &rhs) const;
+
+    void swap(csr_graph &other_graph) noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+    bool empty() const noexcept;
+    size_type edge_count() const noexcept;
+
+    // Returns a set with the nodes adjacent to the given node.
+    std::set<T> get_adjacent_node_values(const T &node_value) const;
+    // Same semantics as directed_graph::neighbors
+    adjacent_nodes_view neighbors(const T &node_value) const noexcept;
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename DirectedGraph>
+csr_graph<T, Hash, KeyEqual>::csr_graph(const DirectedGraph &graph)
+{
+    static_assert(!DirectedGraph::has_edge_properties, "csr_graph keeps no edge properties");
+    const auto &nodes = graph.m_nodes;
+    size_t edge_count = 0;
+    for (auto &&node : nodes)
+        edge_count += node.get_adjacent_node_indices().size();
+
+    // Tombstoned nodes are left out and the rest renumbered the way compact() would do it.
+    constexpr size_t erased = static_cast<size_t>(-1);
+    std::vector<size_t> remap;
+    if (graph.tombstone_count() != 0)
+    {
+        remap.resize(nodes.size());
+        size_t live_count = 0;
+        for (size_t index = 0; index < nodes.size(); ++index)
+            remap[index] = graph.is_erased(index) ? erased : live_count++;
+    }
+
+    m_values.reserve(graph.size());
+    m_offsets.reserve(graph.size() + 1);
+    m_targets.reserve(edge_count);
+    for (size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (!remap.empty() && remap[index] == erased)
+            continue;
+        m_values.push_back(nodes[index].get());
+        // adjacency lists are kept sorted and remap is monotonic, so the targets of each row come out sorted
+        const auto &indices = nodes[index].get_adjacent_node_indices();
+        if (remap.empty())
+        {
+            m_targets.insert(std::end(m_targets), std::begin(indices), std::end(indices));
+        }
+        else
+        {
+            for (auto &&target : indices)
+            {
+                if (remap[target] != erased)
+                    m_targets.push_back(remap[target]);
+            }
+        }
+        m_offsets.push_back(m_targets.size());
+    }
+
+    if constexpr (has_node_index)
+    {
+        m_nodeIndex.reserve(m_values.size());
+        for (size_t index = 0; index < m_values.size(); ++index)
+            m_nodeIndex.insert_absent(m_values[index], index);
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::values_container_type::const_iterator csr_graph<T, Hash, KeyEqual>::find(const T &node_value) const
+{
+    if constexpr (has_node_index)
+    {
+        const size_t found = m_nodeIndex.find(node_value, value_at());
+        if (found == node_index_type::npos)
+            return std::end(m_values);
+        return std::begin(m_values) + found;
+    }
+    else
+    {
+        return std::find_if(std::begin(m_values), std::end(m_values), [&node_value](const auto &value)
+                            { return KeyEqual{}(value, node_value); });
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator csr_graph<T, Hash, KeyEqual>::begin() const noexcept
+{
+    return std::cbegin(m_values);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator csr_graph<T, Hash, KeyEqual>::end() const noexcept
+{
+    return std::cend(m_values);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator csr_graph<T, Hash, KeyEqual>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator csr_graph<T, Hash, KeyEqual>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator csr_graph<T, Hash, KeyEqual>::rbegin() const noexcept
+{
+    return const_reverse_iterator(end());
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator csr_graph<T, Hash, KeyEqual>::rend() const noexcept
+{
+    return const_reverse_iterator(begin());
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator csr_graph<T, Hash, KeyEqual>::crbegin() const noexcept
+{
+    return rbegin();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator csr_graph<T, Hash, KeyEqual>::crend() const noexcept
+{
+    return rend();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::begin(const T &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_values)) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    const size_t index = std::distance(std::begin(m_values), iter);
+    return const_iterator_adjacent_nodes(std::begin(get_adjacent_node_indices(index)), this);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::end(const T &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_values)) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    const size_t index = std::distance(std::begin(m_values), iter);
+    return const_iterator_adjacent_nodes(std::end(get_adjacent_node_indices(index)), this);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::cbegin(const T &node_value) const noexcept
+{
+    return begin(node_value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::cend(const T &node_value) const noexcept
+{
+    return end(node_value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::rbegin(const T &node_value) const noexcept
+{
+    return const_reverse_iterator_adjacent_nodes(end(node_value));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::rend(const T &node_value) const noexcept
+{
+    return const_reverse_iterator_adjacent_nodes(begin(node_value));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::crbegin(const T &node_value) const noexcept
+{
+    return rbegin(node_value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reverse_iterator_adjacent_nodes csr_graph<T, Hash, KeyEqual>::crend(const T &node_value) const noexcept
+{
+    return rend(node_value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reference csr_graph<T, Hash, KeyEqual>::operator[](size_type index) const
+{
+    return m_values[index];
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::const_reference csr_graph<T, Hash, KeyEqual>::at(size_type index) const
+{
+    return m_values.at(index);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::adjacency_list_type csr_graph<T, Hash, KeyEqual>::get_adjacent_node_indices(size_type index) const noexcept
+{
+    return adjacency_list_type(m_targets.data() + m_offsets[index], m_targets.data() + m_offsets[index + 1]);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool csr_graph<T, Hash, KeyEqual>::operator==(const csr_graph &rhs) const
+{
+    if (size() != rhs.size() || edge_count() != rhs.edge_count())
+        return false;
+
+    for (size_t index = 0; index < size(); ++index)
+    {
+        const auto result = rhs.find(m_values[index]);
+        if (result == std::end(rhs.m_values))
+            return false;
+
+        const auto lhs_indices = get_adjacent_node_indices(index);
+        const auto rhs_indices = rhs.get_adjacent_node_indices(std::distance(std::begin(rhs.m_values), result));
+        if (lhs_indices.size() != rhs_indices.size())
+            return false;
+
+        // rhs rows are sorted, so every remapped lhs target can be binary searched
+        for (auto &&target : lhs_indices)
+        {
+            const auto mapped = rhs.find(m_values[target]);
+            if (mapped == std::end(rhs.m_values))
+                return false;
+            const size_t mapped_index = std::distance(std::begin(rhs.m_values), mapped);
+            if (!std::binary_search(std::begin(rhs_indices), std::end(rhs_indices), mapped_index))
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool csr_graph<T, Hash, KeyEqual>::operator!=(const csr_graph &rhs) const
+{
+    return !(*this == rhs);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void csr_graph<T, Hash, KeyEqual>::swap(csr_graph &other) noexcept
+{
+    using std::swap;
+
+    swap(m_values, other.m_values);
+    swap(m_offsets, other.m_offsets);
+    swap(m_targets, other.m_targets);
+    swap(m_nodeIndex, other.m_nodeIndex);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::size_type csr_graph<T, Hash, KeyEqual>::size() const noexcept
+{
+    return m_values.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::size_type csr_graph<T, Hash, KeyEqual>::max_size() const noexcept
+{
+    return m_values.max_size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool csr_graph<T, Hash, KeyEqual>::empty() const noexcept
+{
+    return m_values.empty();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::size_type csr_graph<T, Hash, KeyEqual>::edge_count() const noexcept
+{
+    return m_targets.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename csr_graph<T, Hash, KeyEqual>::adjacent_nodes_view csr_graph<T, Hash, KeyEqual>::neighbors(const T &node_value) const noexcept
+{
+    return adjacent_nodes_view(begin(node_value), end(node_value));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::set<T> csr_graph<T, Hash, KeyEqual>::get_adjacent_node_values(const T &node_value) const
+{
+    std::set<T> values;
+    auto iter = find(node_value);
+    if (iter == std::end(m_values))
+        return values; // return empty set if there is no such node
+
+    for (auto &&index : get_adjacent_node_indices(std::distance(std::begin(m_values), iter)))
+        values.insert(m_values[index]);
+    return values;
+}
+#endif
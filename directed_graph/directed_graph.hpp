@@ -4,33 +4,182 @@
 #include <set>
 #include <string>
 #include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <ranges>
 #include "graph_node.hpp"
+#include "small_flat_set.hpp"
+#include "weighted_adjacency.hpp"
+#include "bitset_adjacency.hpp"
+#include "node_index.hpp"
+#include "csr_graph.hpp"
+#include "execution_dispatch.hpp"
+#include "graph_instrumentation.hpp"
 #include "const_directed_graph_iterator.hpp"
 #include "const_adjacent_nodes_iterator.hpp"
-#include "adjacent_nodes_iterator.hpp"
+
+// How erase() removes nodes from a directed_graph.
+// immediate: the node is removed right away and all indices behind it shift down.
+// deferred: the node is only tombstoned, indices stay stable until compact().
+enum class erase_mode
+{
+    immediate,
+    deferred
+};
 
 // DIrected Graph Implementation
-template <typename T>
+// Node lookups go through a value -> index hash index kept in sync with m_nodes.
+// Pass void as Hash to disable the index and fall back to a linear scan.
+// Adjacency is the per-node container of adjacency indices, see graph_node.
+// Allocator is rebound for the node vector and the bookkeeping containers, and handed on to the
+// values and adjacency lists through the uses-allocator protocol, see the pmr aliases below.
+// The default small_flat_set is rebound to Allocator as well (see rebind_adjacency), so with any
+// allocator the adjacency lists allocate through it; weighted_adjacency and bitset_adjacency are
+// not allocator-aware and keep using std::allocator.
+// Instrumentation collects the counters returned by stats(), see graph_instrumentation.hpp;
+// the default no_instrumentation costs nothing.
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>, typename Adjacency = small_flat_set<std::size_t>, typename Allocator = std::allocator<T>,
+          typename Instrumentation = no_instrumentation>
 class directed_graph
 {
+    template <typename U>
+    using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
 public:
-    using nodes_container_type = std::vector<graph_node<T>>;
+    // Adjacency with Allocator rebound into it where that is possible.
+    using adjacency_type = rebind_adjacency_t<Adjacency, Allocator>;
+    using nodes_container_type = std::vector<graph_node<T, adjacency_type, Allocator>, rebind_alloc<graph_node<T, adjacency_type, Allocator>>>;
     nodes_container_type m_nodes;
 
-    typename nodes_container_type::iterator find(const T &node_value);
-    typename nodes_container_type::const_iterator find(const T &node_value) const;
+    static constexpr bool has_node_index = !std::is_void_v<Hash>;
+    using node_index_type = node_index_t<T, Hash, KeyEqual, Allocator>;
+    [[no_unique_address]] node_index_type m_nodeIndex;
+    // What m_nodeIndex compares lookups with, it keeps no values of its own.
+    auto value_at() const noexcept
+    {
+        return [this](std::size_t index) -> const T & { return m_nodes[index].get(); };
+    }
+
+    template <typename Key = T>
+    typename nodes_container_type::iterator find(const Key &node_value);
+    template <typename Key = T>
+    typename nodes_container_type::const_iterator find(const Key &node_value) const;
+    // Key can be passed to the index, or to KeyEqual without the index, as it is.
+    template <typename Key>
+    static constexpr bool is_lookup_key = has_node_index ? node_index_type::template is_lookup_key<Key>
+                                                         : std::is_invocable_r_v<bool, const KeyEqual &, const T &, const Key &>;
+    // Completes the insertion of m_nodes.back(): tombstone bit, reverse adjacency, reserved degree and
+    // index entry. Removes the node again if that throws.
+    void register_last_node();
+    // Appends a node whose value is constructed from args, handing get_allocator() on to the value
+    // and the adjacency list also when the node allocator does not do that by itself.
+    template <typename... Args>
+    void emplace_node(Args &&...args);
+    // Appends empty incoming lists, built with get_allocator(), until there are count of them.
+    void grow_incoming_lists(std::size_t count);
 
     void remove_all_links_to(typename nodes_container_type::const_iterator node);
-
-    std::set<T> get_adjacent_node_values(const typename graph_node<T>::adjacency_list_type &indices) const;
+    // Removes node_index from one adjacency list and shifts every index above it down by one.
+    static void remove_and_renumber(adjacency_type &indices, std::size_t node_index);
+    // Drops the index entries for [first, last) and shifts the indices of the nodes behind them.
+    void remove_from_node_index(typename nodes_container_type::const_iterator first, typename nodes_container_type::const_iterator last);
+
+    std::set<T> get_adjacent_node_values(const typename graph_node<T, adjacency_type, Allocator>::adjacency_list_type &indices) const;
+
+    // Tombstones of nodes erased in erase_mode::deferred, empty while there are none.
+    // Links to tombstoned nodes stay in the adjacency lists and are skipped until compaction.
+    std::vector<bool, rebind_alloc<bool>> m_tombstones;
+    std::size_t m_tombstoneCount = 0;
+    erase_mode m_eraseMode = erase_mode::immediate;
+    double m_compactionThreshold = 0.0;
+
+    void tombstone(std::size_t index);
+    // Flags a victim of a batch erase. In erase_mode::immediate only the tombstone bit and the index
+    // entry are updated, the links to and from the node are dropped by the compact() that follows.
+    void mark_erased(std::size_t index);
+    // Compacts in erase_mode::immediate, or if the threshold is exceeded in erase_mode::deferred.
+    std::size_t finish_erase(std::size_t position);
+    // Runs mark_victims, which calls mark_erased for every node to erase, then renumbers once.
+    // Returns the number of nodes erased.
+    template <typename MarkVictims>
+    std::size_t erase_batch(MarkVictims mark_victims);
+    // Compacts once the tombstoned fraction exceeds the threshold, returns the new index of position.
+    std::size_t compact_if_needed(std::size_t position);
+    // Drops all tombstoned nodes and renumbers the adjacency lists in one linear pass,
+    // returns the new index of position.
+    std::size_t compact(std::size_t position);
+    static void remap_adjacency(adjacency_type &indices, const std::vector<std::size_t> &remap, std::vector<std::size_t> &scratch);
+
+    // Opt-in reverse adjacency: m_incomingNodeIndices[i] holds the indices of the predecessors of node i.
+    // Empty unless enable_reverse_adjacency() was called.
+    std::vector<adjacency_type, rebind_alloc<adjacency_type>> m_incomingNodeIndices;
+    bool m_hasReverseAdjacency = false;
+
+    // Merges sorted, unique (source, target) index pairs into the lists returned by adjacency_of,
+    // one list per source and in parallel under a parallel policy. Returns the number of new entries.
+    template <typename ExecutionPolicy, typename AdjacencyOf>
+    static std::size_t merge_edges(ExecutionPolicy &&policy, const std::vector<std::pair<std::size_t, std::size_t>> &edges, AdjacencyOf adjacency_of);
+
+    // Number of entries in indices that refer to nodes which are not tombstoned.
+    std::size_t live_degree(const adjacency_type &indices) const noexcept;
+
+    // Out-degree every new adjacency list is reserved for, set by reserve().
+    size_t m_reservedDegree = 0;
+    void reserve_degree(adjacency_type &indices) const;
+
+    // Without the hash index, bulk assignment can still deduplicate by sorting if the values are ordered.
+    static constexpr bool sortable_values = std::totally_ordered<T> && std::is_same_v<KeyEqual, std::equal_to<T>>;
+    // Positions of the first occurrence of every distinct value, ascending. Sorts the positions by
+    // value under policy and compares neighbors only.
+    template <typename ExecutionPolicy>
+    std::vector<size_t> first_occurrences(ExecutionPolicy &&policy, const std::vector<T> &values) const;
+    // Positions in [0, count) of the first occurrence of every value within its chunk of the input,
+    // ascending. Every chunk is deduplicated with its own hash table as a task under policy, so a value
+    // repeated across chunks is still listed once per chunk.
+    template <typename ExecutionPolicy, typename RandomIter>
+    static std::vector<size_t> chunk_first_occurrences(ExecutionPolicy &&policy, RandomIter first, size_t count);
+    // Adds the values of [first, last) to the cleared graph with one index lookup each, values already
+    // there are skipped. The nodes are stored with one reservation if Iter is a forward iterator.
+    template <typename Iter>
+    void assign_indexed(Iter first, Iter last);
+    // Fills the cleared graph, which has no hash index, with values[positions], which must be
+    // distinct, with a single reservation.
+    void assign_distinct(std::vector<T> &values, const std::vector<size_t> &positions);
+
+    [[no_unique_address]] Instrumentation m_instrumentation;
+    // Counts an allocation if a container grew past old_capacity. Node-based containers without
+    // capacity() allocate on every insert, so for them growth in size counts.
+    template <typename Container>
+    void count_growth(const Container &container, std::size_t old_capacity) const noexcept;
+    template <typename Container>
+    static std::size_t capacity_of(const Container &container) noexcept;
 
 public:
     // public type aliases
     using value_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using adjacency_list_type = typename graph_node<T, adjacency_type, Allocator>::adjacency_list_type;
+    using frozen_graph_type = csr_graph<T, Hash, KeyEqual>;
+    using instrumentation_type = Instrumentation;
     using reference = value_type &;
     using const_reference = const value_type &;
     using size_type = size_t;
     using difference_type = ptrdiff_t;
+    // Property stored with every edge when Adjacency keeps one, see weighted_adjacency.
+    using edge_property_type = typename edge_property_of<Adjacency>::type;
+    static constexpr bool has_edge_properties = !std::is_same_v<edge_property_type, no_edge_property>;
 
     // public iterator-related type aliases
     using iterator = const_directed_graph_iterator<directed_graph>;
@@ -38,16 +187,30 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    directed_graph() = default;
+    explicit directed_graph(const Allocator &alloc);
     // ctor taking iterator range
     template <typename Iter>
-    directed_graph(Iter first, Iter last);
+    directed_graph(Iter first, Iter last, const Allocator &alloc = Allocator());
     // ctors and assignment operator taking initializer list
-    directed_graph(std::initializer_list<T> init);
-    directed_graph<T> &operator=(std::initializer_list<T> init);
-    using iterator_adjacent_nodes = adjacent_nodes_iterator<directed_graph>;
+    directed_graph(std::initializer_list<T> init, const Allocator &alloc = Allocator());
+    // allocator-extended copy and move ctors
+    directed_graph(const directed_graph &other, const Allocator &alloc);
+    directed_graph(directed_graph &&other, const Allocator &alloc);
+    // Copies a graph that stores its adjacency lists differently, e.g. to and from dense_directed_graph.
+    // Tombstoned nodes are left out and the rest renumbered the way compact() would do it; edge
+    // properties are copied when both sides keep them.
+    template <typename OtherAdjacency>
+        requires(!std::is_same_v<OtherAdjacency, Adjacency>)
+    explicit directed_graph(const directed_graph<T, Hash, KeyEqual, OtherAdjacency, Allocator, Instrumentation> &other, const Allocator &alloc = Allocator());
+    directed_graph &operator=(std::initializer_list<T> init);
+    // like the node iterators, adjacency iterators only hand out const values
+    using iterator_adjacent_nodes = const_adjacent_nodes_iterator<directed_graph>;
     using const_iterator_adjacent_nodes = const_adjacent_nodes_iterator<directed_graph>;
     using reverse_iterator_adjacent_nodes = std::reverse_iterator<iterator_adjacent_nodes>;
     using const_reverse_iterator_adjacent_nodes = std::reverse_iterator<const_iterator_adjacent_nodes>;
+    // lazy view over the nodes adjacent to one node, see neighbors()
+    using adjacent_nodes_view = std::ranges::subrange<const_iterator_adjacent_nodes>;
 
     // iterators for STL Compliancy
     iterator begin() noexcept;
@@ -71,47 +234,142 @@ public:
 
     // return iterator to the list of adjacent nodes for the given node
     // return a default constructed iterator as the end iterator if the value is not found
-    iterator_adjacent_nodes begin(const T &node_value) noexcept;
-    iterator_adjacent_nodes end(const T &node_value) noexcept;
-
-    const_iterator_adjacent_nodes begin(const T &node_value) const noexcept;
-    const_iterator_adjacent_nodes end(const T &node_value) const noexcept;
-
-    const_iterator_adjacent_nodes cbegin(const T &node_value) const noexcept;
-    const_iterator_adjacent_nodes cend(const T &node_value) const noexcept;
-
-    reverse_iterator_adjacent_nodes rbegin(const T &node_value) noexcept;
-    reverse_iterator_adjacent_nodes rend(const T &node_value) noexcept;
-
-    const_reverse_iterator_adjacent_nodes rbegin(const T &node_value) const noexcept;
-    const_reverse_iterator_adjacent_nodes rend(const T &node_value) const noexcept;
-
-    const_reverse_iterator_adjacent_nodes crbegin(const T &node_value) const noexcept;
-    const_reverse_iterator_adjacent_nodes crend(const T &node_value) const noexcept;
+    template <typename Key = T>
+    iterator_adjacent_nodes begin(const Key &node_value) noexcept;
+    template <typename Key = T>
+    iterator_adjacent_nodes end(const Key &node_value) noexcept;
+
+    template <typename Key = T>
+    const_iterator_adjacent_nodes begin(const Key &node_value) const noexcept;
+    template <typename Key = T>
+    const_iterator_adjacent_nodes end(const Key &node_value) const noexcept;
+
+    template <typename Key = T>
+    const_iterator_adjacent_nodes cbegin(const Key &node_value) const noexcept;
+    template <typename Key = T>
+    const_iterator_adjacent_nodes cend(const Key &node_value) const noexcept;
+
+    template <typename Key = T>
+    reverse_iterator_adjacent_nodes rbegin(const Key &node_value) noexcept;
+    template <typename Key = T>
+    reverse_iterator_adjacent_nodes rend(const Key &node_value) noexcept;
+
+    template <typename Key = T>
+    const_reverse_iterator_adjacent_nodes rbegin(const Key &node_value) const noexcept;
+    template <typename Key = T>
+    const_reverse_iterator_adjacent_nodes rend(const Key &node_value) const noexcept;
+
+    template <typename Key = T>
+    const_reverse_iterator_adjacent_nodes crbegin(const Key &node_value) const noexcept;
+    template <typename Key = T>
+    const_reverse_iterator_adjacent_nodes crend(const Key &node_value) const noexcept;
 
     // For an insert to be successful, the value should not be in the graph yet.
     // Returns true if a new node with given value has been added to
     // the graph, and false if there was already a node with the given value.
     std::pair<iterator, bool> insert(const T &node_value);
     std::pair<iterator, bool> insert(T &&node_value);
-
-    // Returns true if the given node value was erased, false otherwise
+    // Constructs the value from args in place, then keeps it unless an equal value is already in the graph.
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&...args);
+    // Looks up key and, only if there is no such node, constructs the value in place from args,
+    // or from key if args is empty.
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+
+    // Lookups take any Key that Hash and KeyEqual accept. When both are transparent (they declare
+    // is_transparent, e.g. string_hash from node_index.hpp and std::equal_to<>), a Key such as
+    // std::string_view is hashed and compared as it is and no T is constructed; otherwise Key is
+    // converted to T.
+    template <typename Key = T>
+    bool contains(const Key &node_value) const;
+
+    // Returns an iterator to the node following the erased one(s).
+    // In erase_mode::deferred the nodes are only tombstoned, see set_erase_mode().
+    // Erasing a range in erase_mode::immediate renumbers the remaining nodes in a single pass.
     iterator erase(const_iterator pos);
     iterator erase(const_iterator first, const_iterator last);
+    // Batch erase: all victims are flagged first, then the remaining nodes are renumbered and every
+    // adjacency list is rewritten in one O(V + E) pass, however many nodes go. nodes holds
+    // const_iterators into this graph or values to look up; end(), unknown values and duplicates
+    // are ignored. Returns the number of nodes erased.
+    template <std::ranges::input_range Range>
+    size_type erase_nodes(Range &&nodes);
+    size_type erase_nodes(std::initializer_list<T> node_values);
+    // Erases every node whose value satisfies pred, also in a single pass; see the free erase_if.
+    template <typename Predicate>
+    size_type erase_if(Predicate pred);
+
+    // In erase_mode::deferred erase() tombstones nodes in O(out-degree) and keeps all indices stable;
+    // links to erased nodes are dropped lazily and compact() renumbers everything in one pass.
+    void set_erase_mode(erase_mode mode) noexcept;
+    erase_mode get_erase_mode() const noexcept;
+
+    // Compact automatically once more than the given fraction of the nodes is tombstoned, 0 disables.
+    void set_compaction_threshold(double threshold) noexcept;
+    void compact();
+
+    // Tombstoned nodes are skipped by iteration, lookups and size().
+    bool is_erased(size_type index) const noexcept;
+    bool is_erased(typename nodes_container_type::const_iterator node) const noexcept;
+    size_type tombstone_count() const noexcept;
 
     // Returns true if the edge was successfully created, false otherwise
-    bool insert_edge(const T &from_node_value, const T &to_node_value);
+    template <typename From = T, typename To = T>
+    bool insert_edge(const From &from_node_value, const To &to_node_value);
 
     // Returns true if the given edge was erased, false otherwise
-    bool erase_edge(const T &from_node_value, const T &to_node_value);
+    template <typename From = T, typename To = T>
+    bool erase_edge(const From &from_node_value, const To &to_node_value);
+
+    // With edge properties: creates the edge carrying the given property. Like std::map::insert,
+    // returns false and leaves the property alone if the edge already exists.
+    template <typename From = T, typename To = T>
+    bool insert_edge(const From &from_node_value, const To &to_node_value, const edge_property_type &property)
+        requires has_edge_properties;
+    // The property of an edge, throws std::out_of_range if there is no such edge.
+    template <typename From = T, typename To = T>
+    edge_property_type &edge_property(const From &from_node_value, const To &to_node_value)
+        requires has_edge_properties;
+    template <typename From = T, typename To = T>
+    const edge_property_type &edge_property(const From &from_node_value, const To &to_node_value) const
+        requires has_edge_properties;
+
+    // Inserts a range of (from, to) value pairs in bulk: values are resolved in one pass, the edges are
+    // sorted and deduplicated, and every adjacency list is merged once. Pairs naming a value that is not
+    // in the graph are skipped. Returns the number of edges that were new.
+    template <typename Iter>
+    size_type insert_edges(Iter first, Iter last);
+    // Same, with every phase run under the given C++17 execution policy, e.g. std::execution::par.
+    template <typename ExecutionPolicy, typename Iter>
+    size_type insert_edges(ExecutionPolicy &&policy, Iter first, Iter last);
 
     // assign method
+    // Duplicates are dropped in bulk, the first occurrence of a value wins and the nodes keep the
+    // input order. The nodes are stored with one reservation if Iter is a forward iterator.
     template <typename Iter>
     void assign(Iter first, Iter last);
     void assign(std::initializer_list<T> init);
+    // Same, with the duplicates found under the given C++17 execution policy, e.g. std::execution::par.
+    // Chunks of the input are deduplicated as separate tasks, then the values left are added like above,
+    // which also drops the repeats across chunks; without the hash index the values are sorted instead.
+    // This pays off when values repeat: for 5M integers with 100K distinct ones it beats
+    // assign(first, last) even on one core. With mostly distinct values nearly every value still takes
+    // the serial lookup, and the chunk pass adds about a third of the serial time divided by the cores.
+    template <typename ExecutionPolicy, typename Iter>
+    void assign(ExecutionPolicy &&policy, Iter first, Iter last);
+
+    // Makes room for the given number of nodes, and for edges spread evenly over them as the
+    // out-degree of every node, without reallocation. The degree also applies to nodes inserted later.
+    void reserve(size_type node_count, size_type edge_count = 0);
+    // Releases unused capacity of the nodes, the adjacency lists and the index, and drops the reserved degree.
+    void shrink_to_fit();
 
     void clear() noexcept;
 
+    // Values must not be modified in a way that changes their hash or equality,
+    // otherwise the node index gets out of sync.
+    // Indices address m_nodes directly and include tombstoned nodes until compact().
     reference operator[](size_type index);
     const_reference operator[](size_type index) const;
 
@@ -120,74 +378,246 @@ public:
 
     // Two directed graphs are equal if they have the same nodes and edges.
     // The order in which the nodes and edges have been added does not affect equality.
+    // Linear in the number of nodes and edges when the hash index is enabled.
     bool operator==(const directed_graph &rhs) const;
     bool operator!=(const directed_graph &rhs) const;
 
     void swap(directed_graph &other_graph) noexcept;
+    allocator_type get_allocator() const noexcept;
     size_t size() const noexcept;
 
     size_type max_size() const noexcept;
     bool empty() const noexcept;
+    // Number of edges, O(V) or O(V + E) while there are tombstoned nodes.
+    size_type edge_count() const noexcept;
 
     // Returns a set with the nodes adjacent to the given node.
-    std::set<T> get_adjacent_node_values(const T &node_value) const;
+    // Copies every value, prefer neighbors() unless a std::set is needed.
+    template <typename Key = T>
+    std::set<T> get_adjacent_node_values(const Key &node_value) const;
+
+    // Lazy bidirectional view over the values adjacent to the given node, in index order.
+    // Indices are resolved on the fly and tombstoned nodes skipped, nothing is allocated.
+    // The view is empty if the value is not found and is invalidated like the iterators.
+    template <typename Key = T>
+    adjacent_nodes_view neighbors(const Key &node_value) const noexcept;
+
+    // Maintains the incoming edges of every node alongside the outgoing ones, so predecessors
+    // can be iterated in O(in-degree) and erase only visits the neighbors of the erased node.
+    // Enabling builds the reverse adjacency in O(V + E), disabling releases it.
+    void enable_reverse_adjacency(bool enable = true);
+    bool has_reverse_adjacency() const noexcept;
+
+    // return iterator to the list of predecessors of the given node
+    // return a default constructed iterator as the end iterator if the value is not found
+    // or the reverse adjacency is not enabled
+    template <typename Key = T>
+    const_iterator_adjacent_nodes in_begin(const Key &node_value) const noexcept;
+    template <typename Key = T>
+    const_iterator_adjacent_nodes in_end(const Key &node_value) const noexcept;
+
+    // Number of edges pointing to the given node, 0 if the value is not found
+    // or the reverse adjacency is not enabled.
+    template <typename Key = T>
+    size_type in_degree(const Key &node_value) const noexcept;
+
+    // Returns an immutable compressed-sparse-row snapshot of the graph for read-mostly workloads.
+    // Node indices in the snapshot match the indices in this graph after compact().
+    // csr_graph has no property column, so graphs with edge properties cannot be frozen.
+    frozen_graph_type freeze() const;
+
+    // Snapshot of the counters collected by the Instrumentation policy, all zero with no_instrumentation.
+    graph_stats stats() const noexcept;
+    void reset_stats() noexcept;
 };
 
 #include <set>
 
-template <typename T>
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(const Allocator &alloc)
+    : m_nodes(alloc), m_nodeIndex(alloc), m_tombstones(alloc), m_incomingNodeIndices(alloc) {}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
 template <typename Iter>
-directed_graph<T>::directed_graph(Iter first, Iter last)
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(Iter first, Iter last, const Allocator &alloc) : directed_graph(alloc)
 {
     assign(first, last);
 }
 
-template <typename T>
-directed_graph<T>::directed_graph(std::initializer_list<T> init)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(std::initializer_list<T> init, const Allocator &alloc) : directed_graph(alloc)
 {
     assign(std::begin(init), std::end(init));
 }
 
-template <typename T>
-directed_graph<T> &directed_graph<T>::operator=(std::initializer_list<T> init)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(const directed_graph &other, const Allocator &alloc)
+    : m_nodes(other.m_nodes, alloc), m_nodeIndex(alloc), m_tombstones(other.m_tombstones, alloc), m_tombstoneCount(other.m_tombstoneCount),
+      m_eraseMode(other.m_eraseMode), m_compactionThreshold(other.m_compactionThreshold),
+      m_incomingNodeIndices(other.m_incomingNodeIndices, alloc), m_hasReverseAdjacency(other.m_hasReverseAdjacency),
+      m_reservedDegree(other.m_reservedDegree)
+{
+    if constexpr (has_node_index)
+        m_nodeIndex = other.m_nodeIndex;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(directed_graph &&other, const Allocator &alloc)
+    : m_nodes(std::move(other.m_nodes), alloc), m_nodeIndex(alloc), m_tombstones(std::move(other.m_tombstones), alloc), m_tombstoneCount(other.m_tombstoneCount),
+      m_eraseMode(other.m_eraseMode), m_compactionThreshold(other.m_compactionThreshold),
+      m_incomingNodeIndices(std::move(other.m_incomingNodeIndices), alloc), m_hasReverseAdjacency(other.m_hasReverseAdjacency),
+      m_reservedDegree(other.m_reservedDegree)
+{
+    if constexpr (has_node_index)
+        m_nodeIndex = std::move(other.m_nodeIndex);
+    other.clear();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename OtherAdjacency>
+    requires(!std::is_same_v<OtherAdjacency, Adjacency>)
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::directed_graph(const directed_graph<T, Hash, KeyEqual, OtherAdjacency, Allocator, Instrumentation> &other, const Allocator &alloc)
+    : directed_graph(alloc)
+{
+    using other_graph = directed_graph<T, Hash, KeyEqual, OtherAdjacency, Allocator, Instrumentation>;
+    m_eraseMode = other.m_eraseMode;
+    m_compactionThreshold = other.m_compactionThreshold;
+
+    constexpr size_t erased = static_cast<size_t>(-1);
+    std::vector<size_t> remap(other.m_nodes.size(), erased);
+    reserve(other.size());
+    for (size_t index = 0; index < other.m_nodes.size(); ++index)
+    {
+        if (other.is_erased(index))
+            continue;
+        remap[index] = m_nodes.size();
+        insert(other.m_nodes[index].get());
+    }
+
+    for (size_t index = 0; index < other.m_nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        auto &indices = m_nodes[remap[index]].get_adjacent_node_indices();
+        const auto &source = other.m_nodes[index].get_adjacent_node_indices();
+        // remap is monotonic, so the targets are appended in order
+        for (auto iter = std::cbegin(source); iter != std::cend(source); ++iter)
+        {
+            const size_t target = remap[*iter];
+            if (target == erased)
+                continue;
+            if constexpr (has_edge_properties && other_graph::has_edge_properties)
+                indices.insert(target, iter.property());
+            else
+                indices.insert(std::end(indices), target);
+        }
+    }
+    if (other.m_hasReverseAdjacency)
+        enable_reverse_adjacency();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation> &directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::operator=(std::initializer_list<T> init)
 {
     clear();
     assign(std::begin(init), std::end(init));
     return *this;
 }
 
-template <typename T>
-typename directed_graph<T>::nodes_container_type::iterator directed_graph<T>::find(const T &node_value)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::nodes_container_type::iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::find(const Key &node_value)
 {
-    return std::find_if(std::begin(m_nodes), std::end(m_nodes), [&node_value](const auto &node)
-                        { return node.get() == node_value; });
+    if constexpr (!is_lookup_key<Key>)
+    {
+        // Hash or KeyEqual cannot take Key as it is (not transparent), look up a T made from it
+        const T converted(node_value);
+        return find(converted);
+    }
+    else if constexpr (has_node_index)
+    {
+        [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::find);
+        m_instrumentation.count_find_scanned(1);
+        const size_t found = m_nodeIndex.find(node_value, value_at());
+        if (found == node_index_type::npos)
+            return std::end(m_nodes);
+        return std::begin(m_nodes) + found;
+    }
+    else
+    {
+        [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::find);
+        for (auto iter = std::begin(m_nodes); iter != std::end(m_nodes); ++iter)
+        {
+            if (KeyEqual{}(iter->get(), node_value) && !is_erased(iter))
+            {
+                m_instrumentation.count_find_scanned(std::distance(std::begin(m_nodes), iter) + 1);
+                return iter;
+            }
+        }
+        m_instrumentation.count_find_scanned(m_nodes.size());
+        return std::end(m_nodes);
+    }
 }
 
-template <typename T>
-typename directed_graph<T>::nodes_container_type::const_iterator directed_graph<T>::find(const T &node_value) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::nodes_container_type::const_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::find(const Key &node_value) const
 {
-    return const_cast<directed_graph<T> *>(this)->find(node_value);
+    return const_cast<directed_graph *>(this)->find(node_value);
 }
 
-template <typename T>
-std::set<T> directed_graph<T>::get_adjacent_node_values(const typename graph_node<T>::adjacency_list_type &indices) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+std::set<T> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::get_adjacent_node_values(const typename graph_node<T, adjacency_type, Allocator>::adjacency_list_type &indices) const
 {
     std::set<T> values;
     for (auto &&index : indices)
     {
-        values.insert(m_nodes[index].get());
+        if (!is_erased(index))
+            values.insert(m_nodes[index].get());
     }
     return values;
 }
 
-template <typename T>
-void directed_graph<T>::remove_all_links_to(typename nodes_container_type::const_iterator node)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::remove_all_links_to(typename nodes_container_type::const_iterator node)
 {
     const size_t node_index = std::distance(std::cbegin(m_nodes), node);
+    size_t scanned = 0;
+    if (m_hasReverseAdjacency)
+    {
+        // Only the neighbors of the node can link to it, the other lists just need renumbering.
+        for (auto &&predecessor : m_incomingNodeIndices[node_index])
+            m_nodes[predecessor].get_adjacent_node_indices().erase(node_index);
+        for (auto &&successor : m_nodes[node_index].get_adjacent_node_indices())
+            m_incomingNodeIndices[successor].erase(node_index);
+        m_nodes[node_index].get_adjacent_node_indices().clear();
+        m_incomingNodeIndices[node_index].clear();
+        for (auto &&incoming : m_incomingNodeIndices)
+        {
+            scanned += incoming.size();
+            remove_and_renumber(incoming, node_index);
+        }
+    }
+
     for (auto &&node : m_nodes)
     { // Iterate over all adjacency lists.
+        scanned += node.get_adjacent_node_indices().size();
+        remove_and_renumber(node.get_adjacent_node_indices(), node_index);
+    }
+    m_instrumentation.count_links_scanned(scanned);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::remove_and_renumber(adjacency_type &adjacencyIndices, size_t node_index)
+{
+    if constexpr (requires { adjacencyIndices.remove_and_renumber(node_index); })
+    {
+        // flat adjacency lists can renumber in place
+        adjacencyIndices.remove_and_renumber(node_index);
+    }
+    else
+    {
         // First remove references to the to-be-deleted node.
-        auto &adjacencyIndices = node.get_adjacent_node_indices();
         adjacencyIndices.erase(node_index);
         // Second, modify all remaining adjacency indices to account for the removal of a node.
         for (auto iter = std::begin(adjacencyIndices); iter != std::end(adjacencyIndices);)
@@ -208,229 +638,682 @@ void directed_graph<T>::remove_all_links_to(typename nodes_container_type::const
     }
 }
 
-template <typename T>
-size_t directed_graph<T>::size() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::remove_from_node_index(typename nodes_container_type::const_iterator first, typename nodes_container_type::const_iterator last)
+{
+    if constexpr (has_node_index)
+    {
+        const size_t first_index = std::distance(std::cbegin(m_nodes), first);
+        const size_t last_index = std::distance(std::cbegin(m_nodes), last);
+        for (auto iter = first; iter != last; ++iter)
+            m_nodeIndex.erase(iter->get(), value_at());
+
+        const size_t removed = last_index - first_index;
+        m_nodeIndex.renumber([last_index, removed](size_t index)
+                             { return index >= last_index ? index - removed : index; });
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size() const noexcept
+{
+    return m_nodes.size() - m_tombstoneCount;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::edge_count() const noexcept
+{
+    size_t edges = 0;
+    for (size_t index = 0; index < m_nodes.size(); ++index)
+    {
+        if (!is_erased(index))
+            edges += live_degree(m_nodes[index].get_adjacent_node_indices());
+    }
+    return edges;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::live_degree(const adjacency_type &indices) const noexcept
 {
-    return m_nodes.size();
+    if (m_tombstoneCount == 0)
+        return indices.size();
+    return std::count_if(std::cbegin(indices), std::cend(indices), [this](size_t index)
+                         { return !is_erased(index); });
 }
 
-template <typename T>
-typename directed_graph<T>::size_type directed_graph<T>::max_size() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::allocator_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::get_allocator() const noexcept
+{
+    return allocator_type(m_nodes.get_allocator());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::max_size() const noexcept
 {
     return m_nodes.max_size();
 }
 
-template <typename T>
-bool directed_graph<T>::empty() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::empty() const noexcept
 {
-    return m_nodes.empty();
+    return size() == 0;
 }
 
-template <typename T>
-typename directed_graph<T>::iterator directed_graph<T>::begin() noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::begin() noexcept
 {
-    return iterator(std::begin(m_nodes), this);
+    auto first = std::begin(m_nodes);
+    while (is_erased(first))
+        ++first;
+    return iterator(first, this);
 }
 
-template <typename T>
-typename directed_graph<T>::iterator directed_graph<T>::end() noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::end() noexcept
 {
     return iterator(std::end(m_nodes), this);
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator directed_graph<T>::begin() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::begin() const noexcept
 {
     return const_cast<directed_graph *>(this)->begin();
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator directed_graph<T>::end() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::end() const noexcept
 {
     return const_cast<directed_graph *>(this)->end();
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator directed_graph<T>::cbegin() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::cbegin() const noexcept
 {
     return const_cast<directed_graph *>(this)->begin();
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator directed_graph<T>::cend() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::cend() const noexcept
 {
     return const_cast<directed_graph *>(this)->end();
 }
 
-template <typename T>
-typename directed_graph<T>::reverse_iterator directed_graph<T>::rbegin() noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rbegin() noexcept
 {
     return reverse_iterator(end());
 }
 
-template <typename T>
-typename directed_graph<T>::reverse_iterator directed_graph<T>::rend() noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rend() noexcept
 {
     return reverse_iterator(begin());
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator directed_graph<T>::rbegin() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rbegin() const noexcept
 {
     return const_cast<directed_graph *>(this)->rbegin();
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator directed_graph<T>::rend() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rend() const noexcept
 {
     return const_cast<directed_graph *>(this)->rend();
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator directed_graph<T>::crbegin() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::crbegin() const noexcept
 {
     return const_cast<directed_graph *>(this)->rbegin();
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator directed_graph<T>::crend() const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::crend() const noexcept
 {
     return const_cast<directed_graph *>(this)->rend();
 }
 
-template <typename T>
-typename directed_graph<T>::iterator_adjacent_nodes directed_graph<T>::begin(const T &node_value) noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::begin(const Key &node_value) noexcept
 {
     auto iter = find(node_value);
     if (iter == std::end(m_nodes)) // return a default constructed end iterator
-        return adjacent_nodes_iterator<directed_graph>();
-    return adjacent_nodes_iterator<directed_graph>(std::begin(iter->get_adjacent_node_indices()), this);
+        return iterator_adjacent_nodes();
+    const auto &indices = iter->get_adjacent_node_indices();
+    return iterator_adjacent_nodes(std::cbegin(indices), std::cend(indices), this);
 }
 
-template <typename T>
-typename directed_graph<T>::iterator_adjacent_nodes directed_graph<T>::end(const T &node_value) noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::end(const Key &node_value) noexcept
 {
     auto iter = find(node_value);
     if (iter == std::end(m_nodes)) // return a default constructed end iterator
-        return adjacent_nodes_iterator<directed_graph>();
-    return adjacent_nodes_iterator<directed_graph>(std::end(iter->get_adjacent_node_indices()), this);
+        return iterator_adjacent_nodes();
+    const auto &indices = iter->get_adjacent_node_indices();
+    return iterator_adjacent_nodes(std::cend(indices), std::cend(indices), this);
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator_adjacent_nodes directed_graph<T>::begin(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::begin(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->begin(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator_adjacent_nodes directed_graph<T>::end(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::end(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->end(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator_adjacent_nodes directed_graph<T>::cbegin(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::cbegin(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->begin(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_iterator_adjacent_nodes directed_graph<T>::cend(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::cend(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->end(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::reverse_iterator_adjacent_nodes directed_graph<T>::rbegin(const T &node_value) noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rbegin(const Key &node_value) noexcept
 {
-    return reverse_iterator(end(node_value));
+    return reverse_iterator_adjacent_nodes(end(node_value));
 }
 
-template <typename T>
-typename directed_graph<T>::reverse_iterator_adjacent_nodes directed_graph<T>::rend(const T &node_value) noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rend(const Key &node_value) noexcept
 {
-    return reverse_iterator(begin(node_value));
+    return reverse_iterator_adjacent_nodes(begin(node_value));
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator_adjacent_nodes directed_graph<T>::rbegin(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rbegin(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->rbegin(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator_adjacent_nodes directed_graph<T>::rend(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::rend(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->rend(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator_adjacent_nodes directed_graph<T>::crbegin(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::crbegin(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->rbegin(node_value);
 }
 
-template <typename T>
-typename directed_graph<T>::const_reverse_iterator_adjacent_nodes directed_graph<T>::crend(const T &node_value) const noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reverse_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::crend(const Key &node_value) const noexcept
 {
     return const_cast<directed_graph *>(this)->rend(node_value);
 }
 
-template <typename T>
-std::pair<typename directed_graph<T>::iterator, bool> directed_graph<T>::insert(T &&node_value)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+std::pair<typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator, bool> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert(T &&node_value)
 {
-    auto iter = find(node_value);
+    return try_emplace(node_value, std::move(node_value));
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+std::pair<typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator, bool> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert(const T &node_value)
+{
+    // copies only if the value is not in the graph yet
+    return try_emplace(node_value, node_value);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename... Args>
+std::pair<typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator, bool> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::emplace(Args &&...args)
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::insert);
+    const size_t capacity = m_nodes.capacity();
+    emplace_node(std::forward<Args>(args)...);
+    count_growth(m_nodes, capacity);
+    // the new node is in neither the index nor the tombstones yet, it is compared with the others only
+    const auto others_end = std::prev(std::end(m_nodes));
+    auto existing = others_end;
+    if constexpr (has_node_index)
+    {
+        existing = find(m_nodes.back().get());
+    }
+    else
+    {
+        [[maybe_unused]] const auto find_timer = m_instrumentation.operation(graph_operation::find);
+        existing = std::begin(m_nodes);
+        while (existing != others_end && (is_erased(existing) || !KeyEqual{}(existing->get(), others_end->get())))
+            ++existing;
+        m_instrumentation.count_find_scanned(std::distance(std::begin(m_nodes), existing) + 1);
+    }
+    if (existing != std::end(m_nodes) && existing != others_end)
+    {
+        const size_t index = std::distance(std::begin(m_nodes), existing);
+        m_nodes.pop_back();
+        return std::make_pair(iterator(std::begin(m_nodes) + index, this), false);
+    }
+    register_last_node();
+    return std::make_pair(iterator(--std::end(m_nodes), this), true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key, typename... Args>
+std::pair<typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator, bool> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::try_emplace(const Key &key, Args &&...args)
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::insert);
+    auto iter = find(key);
     if (iter != std::end(m_nodes))
     {
         return std::make_pair(iterator(iter, this), false); // value is already in the graph, return false.
     }
-    m_nodes.emplace_back(std::move(node_value));
+    const size_t capacity = m_nodes.capacity();
+    if constexpr (sizeof...(Args) == 0)
+        emplace_node(key);
+    else
+        emplace_node(std::forward<Args>(args)...);
+    count_growth(m_nodes, capacity);
+    register_last_node();
     return std::make_pair(iterator(--std::end(m_nodes), this), true); // Value successfully added to the graph, return true.
 }
 
-template <typename T>
-std::pair<typename directed_graph<T>::iterator, bool> directed_graph<T>::insert(const T &node_value)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename... Args>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::emplace_node(Args &&...args)
+{
+    if constexpr (constructs_using_allocator_v<typename nodes_container_type::allocator_type>)
+        m_nodes.emplace_back(std::in_place, std::forward<Args>(args)...);
+    else
+        m_nodes.emplace_back(std::allocator_arg, get_allocator(), std::in_place, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::grow_incoming_lists(size_t count)
+{
+    if constexpr (constructs_using_allocator_v<typename decltype(m_incomingNodeIndices)::allocator_type>)
+    {
+        m_incomingNodeIndices.resize(count);
+    }
+    else
+    {
+        m_incomingNodeIndices.reserve(count);
+        while (m_incomingNodeIndices.size() < count)
+            m_incomingNodeIndices.push_back(std::make_obj_using_allocator<adjacency_type>(get_allocator()));
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::register_last_node()
+{
+    try
+    {
+        if (!m_tombstones.empty())
+            m_tombstones.push_back(false);
+        if (m_hasReverseAdjacency)
+            grow_incoming_lists(m_nodes.size());
+        if (m_reservedDegree != 0)
+            reserve_degree(m_nodes.back().get_adjacent_node_indices());
+        if constexpr (has_node_index)
+            m_nodeIndex.insert_absent(m_nodes.back().get(), m_nodes.size() - 1);
+    }
+    catch (...)
+    {
+        // keep m_nodes, the tombstones, the reverse adjacency and the index consistent
+        if (m_tombstones.size() == m_nodes.size())
+            m_tombstones.pop_back();
+        if (m_hasReverseAdjacency && m_incomingNodeIndices.size() == m_nodes.size())
+            m_incomingNodeIndices.pop_back();
+        m_nodes.pop_back();
+        throw;
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::contains(const Key &node_value) const
 {
-    T copy(node_value);
-    return insert(std::move(copy));
+    return find(node_value) != std::end(m_nodes);
 }
 
-template <typename T>
-typename directed_graph<T>::iterator directed_graph<T>::erase(const_iterator pos)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase(const_iterator pos)
 {
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::erase);
 
     if (pos.m_nodeIterator == std::end(m_nodes))
     {
         return iterator(std::end(m_nodes), this); // Value not in the graph, return end iterator.
     }
 
+    if (m_eraseMode == erase_mode::deferred)
+    {
+        size_t index = std::distance(std::cbegin(m_nodes), pos.m_nodeIterator);
+        tombstone(index);
+        while (index < m_nodes.size() && is_erased(index))
+            ++index;
+        return iterator(std::begin(m_nodes) + compact_if_needed(index), this);
+    }
+
     remove_all_links_to(pos.m_nodeIterator);
+    remove_from_node_index(pos.m_nodeIterator, std::next(pos.m_nodeIterator));
+    if (!m_tombstones.empty())
+        m_tombstones.erase(std::begin(m_tombstones) + std::distance(std::cbegin(m_nodes), pos.m_nodeIterator));
+    if (m_hasReverseAdjacency)
+        m_incomingNodeIndices.erase(std::begin(m_incomingNodeIndices) + std::distance(std::cbegin(m_nodes), pos.m_nodeIterator));
     return iterator(m_nodes.erase(pos.m_nodeIterator), this);
 }
 
-template <typename T>
-typename directed_graph<T>::iterator directed_graph<T>::erase(const_iterator first, const_iterator last)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::iterator directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase(const_iterator first, const_iterator last)
 {
-    for (auto iter = first; iter != last; ++iter)
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::erase_range);
+    // Tombstone the whole range first so the remaining nodes are renumbered only once.
+    const size_t first_index = std::distance(std::cbegin(m_nodes), first.m_nodeIterator);
+    const size_t last_index = std::distance(std::cbegin(m_nodes), last.m_nodeIterator);
+    for (size_t index = first_index; index < last_index; ++index)
+    {
+        if (!is_erased(index))
+            mark_erased(index);
+    }
+    return iterator(std::begin(m_nodes) + finish_erase(last_index), this);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <std::ranges::input_range Range>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase_nodes(Range &&nodes)
+{
+    return erase_batch([this, &nodes]
+                       {
+        for (auto &&node : nodes)
+        {
+            if constexpr (std::is_convertible_v<decltype(node), const_iterator>)
+            {
+                const auto pos = static_cast<const_iterator>(node).m_nodeIterator;
+                if (pos == std::cend(m_nodes))
+                    continue;
+                const size_t index = std::distance(std::cbegin(m_nodes), pos);
+                if (!is_erased(index))
+                    mark_erased(index);
+            }
+            else
+            {
+                // find() no longer sees flagged nodes, so duplicates are skipped
+                const auto pos = std::as_const(*this).find(node);
+                if (pos != std::cend(m_nodes))
+                    mark_erased(std::distance(std::cbegin(m_nodes), pos));
+            }
+        } });
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase_nodes(std::initializer_list<T> node_values)
+{
+    return erase_nodes(std::views::all(node_values));
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Predicate>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase_if(Predicate pred)
+{
+    return erase_batch([this, &pred]
+                       {
+        for (size_t index = 0; index < m_nodes.size(); ++index)
+        {
+            if (!is_erased(index) && pred(std::as_const(m_nodes[index]).get()))
+                mark_erased(index);
+        } });
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename MarkVictims>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase_batch(MarkVictims mark_victims)
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::erase_batch);
+    const size_t tombstones_before = m_tombstoneCount;
+    try
+    {
+        mark_victims();
+    }
+    catch (...)
+    {
+        // the nodes flagged before the exception are erased
+        finish_erase(0);
+        throw;
+    }
+    const size_t erased = m_tombstoneCount - tombstones_before;
+    finish_erase(0);
+    return erased;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::mark_erased(size_t index)
+{
+    if (m_eraseMode == erase_mode::deferred)
+    {
+        tombstone(index);
+        return;
+    }
+    if (m_tombstones.empty())
+        m_tombstones.resize(m_nodes.size());
+    m_tombstones[index] = true;
+    ++m_tombstoneCount;
+    if constexpr (has_node_index)
+        m_nodeIndex.erase(m_nodes[index].get(), value_at());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::finish_erase(size_t position)
+{
+    return m_eraseMode == erase_mode::deferred ? compact_if_needed(position) : compact(position);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::tombstone(size_t index)
+{
+    if (m_tombstones.empty())
+        m_tombstones.resize(m_nodes.size());
+    m_tombstones[index] = true;
+    ++m_tombstoneCount;
+
+    // Outgoing links go away right now, incoming links are skipped until compaction
+    // unless the reverse adjacency tells us where they are.
+    auto &outgoing = m_nodes[index].get_adjacent_node_indices();
+    if (m_hasReverseAdjacency)
+    {
+        for (auto &&successor : outgoing)
+            m_incomingNodeIndices[successor].erase(index);
+        for (auto &&predecessor : m_incomingNodeIndices[index])
+            m_nodes[predecessor].get_adjacent_node_indices().erase(index);
+        m_incomingNodeIndices[index].clear();
+    }
+    outgoing.clear();
+    if constexpr (has_node_index)
+        m_nodeIndex.erase(m_nodes[index].get(), value_at());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::compact_if_needed(size_t position)
+{
+    if (m_compactionThreshold > 0.0 && m_tombstoneCount > m_compactionThreshold * m_nodes.size())
+        return compact(position);
+    return position;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::compact(size_t position)
+{
+    if (m_tombstoneCount == 0)
+        return position;
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::compact);
+
+    constexpr size_t erased = static_cast<size_t>(-1);
+    std::vector<size_t> remap(m_nodes.size());
+    size_t live_count = 0;
+    size_t new_position = m_nodes.size() - m_tombstoneCount;
+    for (size_t index = 0; index < m_nodes.size(); ++index)
+    {
+        if (index == position)
+            new_position = live_count;
+        remap[index] = m_tombstones[index] ? erased : live_count++;
+    }
+
+    std::vector<size_t> scratch;
+    size_t scanned = 0;
+    for (size_t index = 0; index < m_nodes.size(); ++index)
     {
-        if (iter.m_nodeIterator != std::end(m_nodes))
+        if (remap[index] == erased)
+            continue;
+        scanned += m_nodes[index].get_adjacent_node_indices().size();
+        remap_adjacency(m_nodes[index].get_adjacent_node_indices(), remap, scratch);
+        if (m_hasReverseAdjacency)
+        {
+            scanned += m_incomingNodeIndices[index].size();
+            remap_adjacency(m_incomingNodeIndices[index], remap, scratch);
+        }
+        if (remap[index] != index)
         {
-            remove_all_links_to(iter.m_nodeIterator);
+            m_nodes[remap[index]] = std::move(m_nodes[index]);
+            if (m_hasReverseAdjacency)
+                m_incomingNodeIndices[remap[index]] = std::move(m_incomingNodeIndices[index]);
         }
     }
+    m_nodes.erase(std::begin(m_nodes) + live_count, std::end(m_nodes));
+    if (m_hasReverseAdjacency)
+        m_incomingNodeIndices.resize(live_count);
+
+    if constexpr (has_node_index)
+    {
+        m_nodeIndex.renumber([&remap](size_t index)
+                             { return remap[index]; });
+    }
+    m_tombstones.clear();
+    m_tombstoneCount = 0;
+    m_instrumentation.count_links_scanned(scanned);
+    return new_position;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::remap_adjacency(adjacency_type &indices, const std::vector<size_t> &remap, std::vector<size_t> &scratch)
+{
+    if constexpr (requires { indices.remap(remap); })
+    {
+        // lists carrying edge properties renumber in place so the properties stay with their edges
+        indices.remap(remap);
+        return;
+    }
+
+    // remap is monotonic, so the remapped indices stay sorted
+    scratch.clear();
+    for (auto &&index : indices)
+    {
+        if (remap[index] != static_cast<size_t>(-1))
+            scratch.push_back(remap[index]);
+    }
+
+    if constexpr (requires { indices.assign_sorted_unique(std::cbegin(scratch), std::cend(scratch)); })
+    {
+        indices.assign_sorted_unique(std::cbegin(scratch), std::cend(scratch));
+    }
+    else
+    {
+        indices.clear();
+        for (auto &&index : scratch)
+            indices.insert(std::end(indices), index);
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Container>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::capacity_of(const Container &container) noexcept
+{
+    if constexpr (requires { container.capacity(); })
+        return container.capacity();
+    else
+        return container.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Container>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::count_growth(const Container &container, size_t old_capacity) const noexcept
+{
+    if (capacity_of(container) > old_capacity)
+        m_instrumentation.count_allocation();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::set_erase_mode(erase_mode mode) noexcept
+{
+    m_eraseMode = mode;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+erase_mode directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::get_erase_mode() const noexcept
+{
+    return m_eraseMode;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::set_compaction_threshold(double threshold) noexcept
+{
+    m_compactionThreshold = threshold;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::compact()
+{
+    compact(m_nodes.size());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::is_erased(size_type index) const noexcept
+{
+    return m_tombstoneCount != 0 && m_tombstones[index];
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::is_erased(typename nodes_container_type::const_iterator node) const noexcept
+{
+    return m_tombstoneCount != 0 && node != std::cend(m_nodes) && m_tombstones[std::distance(std::cbegin(m_nodes), node)];
+}
 
-    return iterator(m_nodes.erase(first.m_nodeIterator, last.m_nodeIterator), this);
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::tombstone_count() const noexcept
+{
+    return m_tombstoneCount;
 }
 
-template <typename T>
-void directed_graph<T>::clear() noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::clear() noexcept
 {
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::clear);
     m_nodes.clear();
+    if constexpr (has_node_index)
+        m_nodeIndex.clear();
+    m_tombstones.clear();
+    m_tombstoneCount = 0;
+    m_incomingNodeIndices.clear();
 }
 
-template <typename T>
-bool directed_graph<T>::insert_edge(const T &from_node_value, const T &to_node_value)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename From, typename To>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert_edge(const From &from_node_value, const To &to_node_value)
 {
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::insert_edge);
     const auto from = find(from_node_value);
     const auto to = find(to_node_value);
     if (from == std::end(m_nodes) || to == std::end(m_nodes))
@@ -439,12 +1322,20 @@ bool directed_graph<T>::insert_edge(const T &from_node_value, const T &to_node_v
     }
 
     const size_t to_index = std::distance(std::begin(m_nodes), to);
-    return from->get_adjacent_node_indices().insert(to_index).second;
+    auto &indices = from->get_adjacent_node_indices();
+    const size_t capacity = capacity_of(indices);
+    const bool inserted = indices.insert(to_index).second;
+    count_growth(indices, capacity);
+    if (inserted && m_hasReverseAdjacency)
+        m_incomingNodeIndices[to_index].insert(std::distance(std::begin(m_nodes), from));
+    return inserted;
 }
 
-template <typename T>
-bool directed_graph<T>::erase_edge(const T &from_node_value, const T &to_node_value)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename From, typename To>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::erase_edge(const From &from_node_value, const To &to_node_value)
 {
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::erase_edge);
     const auto from = find(from_node_value);
     const auto to = find(to_node_value);
     if (from == std::end(m_nodes) || to == std::end(m_nodes))
@@ -454,50 +1345,402 @@ bool directed_graph<T>::erase_edge(const T &from_node_value, const T &to_node_va
 
     const size_t to_index = std::distance(std::begin(m_nodes), to);
     from->get_adjacent_node_indices().erase(to_index);
+    if (m_hasReverseAdjacency)
+        m_incomingNodeIndices[to_index].erase(std::distance(std::begin(m_nodes), from));
     return true;
 }
 
-template <typename T>
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
 template <typename Iter>
-void directed_graph<T>::assign(Iter first, Iter last)
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert_edges(Iter first, Iter last)
 {
-    clear();
+    return insert_edges(serial_policy{}, first, last);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename ExecutionPolicy, typename Iter>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert_edges(ExecutionPolicy &&policy, Iter first, Iter last)
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::insert_edges);
+    using edge = std::pair<size_t, size_t>;
+    static constexpr size_t not_found = static_cast<size_t>(-1);
+
+    const auto resolve = [this](const auto &value_pair)
+    {
+        const auto from = std::as_const(*this).find(value_pair.first);
+        const auto to = std::as_const(*this).find(value_pair.second);
+        if (from == std::cend(m_nodes) || to == std::cend(m_nodes))
+            return edge(not_found, not_found);
+        return edge(std::distance(std::cbegin(m_nodes), from), std::distance(std::cbegin(m_nodes), to));
+    };
+
+    std::vector<edge> edges;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>)
+    {
+        edges.resize(std::distance(first, last));
+        execution_dispatch::transform(policy, first, last, std::begin(edges), resolve);
+    }
+    else
+    {
+        for (auto iter = first; iter != last; ++iter)
+            edges.push_back(resolve(*iter));
+    }
+
+    edges.erase(execution_dispatch::remove_if(policy, std::begin(edges), std::end(edges), [](const edge &e)
+                                              { return e.first == not_found; }),
+                std::end(edges));
+    execution_dispatch::sort(policy, std::begin(edges), std::end(edges), std::less<edge>());
+    edges.erase(execution_dispatch::unique(policy, std::begin(edges), std::end(edges)), std::end(edges));
+
+    const size_t inserted = merge_edges(policy, edges, [this](size_t index) -> adjacency_type &
+                                        { return m_nodes[index].get_adjacent_node_indices(); });
+    if (m_hasReverseAdjacency && inserted != 0)
+    {
+        for (auto &&e : edges)
+            std::swap(e.first, e.second);
+        execution_dispatch::sort(policy, std::begin(edges), std::end(edges), std::less<edge>());
+        merge_edges(policy, edges, [this](size_t index) -> adjacency_type &
+                    { return m_incomingNodeIndices[index]; });
+    }
+    return inserted;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename ExecutionPolicy, typename AdjacencyOf>
+size_t directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::merge_edges(ExecutionPolicy &&policy, const std::vector<std::pair<size_t, size_t>> &edges, AdjacencyOf adjacency_of)
+{
+    // [first, last) of the edges leaving each source node
+    std::vector<std::pair<size_t, size_t>> groups;
+    for (size_t first = 0; first < edges.size();)
+    {
+        size_t last = first + 1;
+        while (last < edges.size() && edges[last].first == edges[first].first)
+            ++last;
+        groups.emplace_back(first, last);
+        first = last;
+    }
+
+    // every group writes to a different adjacency list, so the groups can be merged concurrently
+    return execution_dispatch::transform_reduce(policy, std::cbegin(groups), std::cend(groups), size_t{0}, std::plus<size_t>(), [&edges, &adjacency_of](const auto &group)
+                                                {
+        auto &indices = adjacency_of(edges[group.first].first);
+        const auto first = std::cbegin(edges) + group.first;
+        const auto last = std::cbegin(edges) + group.second;
+        if constexpr (requires { indices.merge_sorted_unique(first, last, &std::pair<size_t, size_t>::second); })
+        {
+            return indices.merge_sorted_unique(first, last, &std::pair<size_t, size_t>::second);
+        }
+        else
+        {
+            const size_t old_size = indices.size();
+            for (auto iter = first; iter != last; ++iter)
+                indices.insert(std::end(indices), iter->second);
+            return indices.size() - old_size;
+        } });
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Iter>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::assign(Iter first, Iter last)
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::assign);
+    if constexpr (!has_node_index && sortable_values)
+    {
+        // the values are buffered so they can be sorted, the graph is cleared only once they are
+        std::vector<T> values(first, last);
+        const auto positions = first_occurrences(serial_policy{}, values);
+        clear();
+        assign_distinct(values, positions);
+    }
+    else
+    {
+        clear();
+        if constexpr (!has_node_index)
+        {
+            // nothing to deduplicate with but KeyEqual, every insert scans the nodes
+            for (auto iter = first; iter != last; ++iter)
+                insert(*iter);
+        }
+        else
+        {
+            assign_indexed(first, last);
+        }
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename ExecutionPolicy, typename Iter>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::assign(ExecutionPolicy &&policy, Iter first, Iter last)
+{
+    if constexpr (!has_node_index && sortable_values)
+    {
+        [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::assign);
+        std::vector<T> values(first, last);
+        const auto positions = first_occurrences(policy, values);
+        clear();
+        assign_distinct(values, positions);
+    }
+    else if constexpr (!has_node_index)
+    {
+        assign(first, last);
+    }
+    else if constexpr (!std::random_access_iterator<Iter>)
+    {
+        // the chunks are cut by position
+        const std::vector<T> values(first, last);
+        assign(std::forward<ExecutionPolicy>(policy), std::cbegin(values), std::cend(values));
+    }
+    else
+    {
+        [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::assign);
+        const auto positions = chunk_first_occurrences(policy, first, static_cast<size_t>(std::distance(first, last)));
+        // The first occurrence of a value in the input is its first occurrence in the earliest chunk
+        // holding it, so the serial path keeps that one and skips the repeats from later chunks.
+        clear();
+        const auto kept = positions | std::views::transform([first](size_t position) -> decltype(auto)
+                                                             { return first[position]; });
+        assign_indexed(std::begin(kept), std::end(kept));
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Iter>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::assign_indexed(Iter first, Iter last)
+{
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>)
+    {
+        const auto count = static_cast<size_type>(std::distance(first, last));
+        const size_t capacity = m_nodes.capacity();
+        m_nodes.reserve(count);
+        count_growth(m_nodes, capacity);
+        m_nodeIndex.reserve(count);
+    }
+    // one lookup per value, the index entry is made first and names the node about to be added
     for (auto iter = first; iter != last; ++iter)
-        insert(*iter);
+    {
+        const T &value = *iter;
+        const size_t index = m_nodes.size();
+        if (!m_nodeIndex.try_emplace(value, index, value_at()).second)
+            continue;
+        try
+        {
+            emplace_node(value);
+        }
+        catch (...)
+        {
+            // the entry names a node that is not there, value stands in for it
+            m_nodeIndex.erase(value, [this, index, &value](size_t at) -> const T &
+                              { return at == index ? value : m_nodes[at].get(); });
+            throw;
+        }
+        if (m_reservedDegree != 0)
+            reserve_degree(m_nodes.back().get_adjacent_node_indices());
+    }
+    if (m_hasReverseAdjacency)
+        grow_incoming_lists(m_nodes.size());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename ExecutionPolicy>
+std::vector<size_t> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::first_occurrences(ExecutionPolicy &&policy, const std::vector<T> &values) const
+{
+    std::vector<size_t> order(values.size());
+    std::iota(std::begin(order), std::end(order), size_t{0});
+    execution_dispatch::sort(policy, std::begin(order), std::end(order), [&values](size_t lhs, size_t rhs)
+                             {
+        if (values[lhs] < values[rhs])
+            return true;
+        return !(values[rhs] < values[lhs]) && lhs < rhs; });
+    std::vector<bool> keep(values.size(), false);
+    for (size_t first = 0; first < order.size();)
+    {
+        // [first, last) are equal values, the earliest position first
+        keep[order[first]] = true;
+        size_t last = first + 1;
+        while (last < order.size() && KeyEqual{}(values[order[last]], values[order[first]]))
+            ++last;
+        first = last;
+    }
+
+    std::vector<size_t> positions;
+    for (size_t position = 0; position < keep.size(); ++position)
+    {
+        if (keep[position])
+            positions.push_back(position);
+    }
+    return positions;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename ExecutionPolicy, typename RandomIter>
+std::vector<size_t> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::chunk_first_occurrences(ExecutionPolicy &&policy, RandomIter first, size_t count)
+{
+    // A few chunks per hardware thread, so the tasks balance, but large enough that most repeats are
+    // found in parallel rather than by the serial lookups afterwards.
+    constexpr size_t min_chunk_size = size_t{1} << 16;
+    const size_t task_count = 4 * std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t chunk_size = std::max(min_chunk_size, (count + task_count - 1) / task_count);
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<size_t>> kept(chunk_count);
+    std::vector<size_t> chunk_ids(chunk_count);
+    std::iota(std::begin(chunk_ids), std::end(chunk_ids), size_t{0});
+    execution_dispatch::for_each(policy, std::begin(chunk_ids), std::end(chunk_ids), [&](size_t chunk)
+                                 {
+        // Open addressing over (hash, position) slots, kept at most half full and doubled as the chunk's
+        // distinct values grow, so there is no allocation per value. The mixed high bits of the hash
+        // pick the slot, since e.g. std::hash<int> is the identity.
+        constexpr size_t empty = static_cast<size_t>(-1);
+        std::vector<std::pair<size_t, size_t>> slots(1024, {0, empty});
+        int shift = 64 - std::countr_zero(slots.size());
+        const auto home = [&shift](size_t hash)
+        { return static_cast<size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift); };
+        const size_t chunk_first = chunk * chunk_size;
+        const size_t chunk_last = std::min(chunk_first + chunk_size, count);
+        for (size_t position = chunk_first; position < chunk_last; ++position)
+        {
+            const size_t hash = Hash{}(first[position]);
+            size_t slot = home(hash);
+            while (slots[slot].second != empty && !(slots[slot].first == hash && KeyEqual{}(first[slots[slot].second], first[position])))
+                slot = (slot + 1) & (slots.size() - 1);
+            if (slots[slot].second != empty)
+                continue;
+            slots[slot] = {hash, position};
+            kept[chunk].push_back(position);
+            if (2 * kept[chunk].size() > slots.size())
+            {
+                std::vector<std::pair<size_t, size_t>> grown(2 * slots.size(), {0, empty});
+                --shift;
+                for (auto &&entry : slots)
+                {
+                    if (entry.second == empty)
+                        continue;
+                    size_t moved = home(entry.first);
+                    while (grown[moved].second != empty)
+                        moved = (moved + 1) & (grown.size() - 1);
+                    grown[moved] = entry;
+                }
+                slots.swap(grown);
+            }
+        } });
+
+    // the chunks follow the input order, so their positions concatenate to an ascending list
+    std::vector<size_t> positions;
+    for (auto &&chunk_positions : kept)
+        positions.insert(std::end(positions), std::cbegin(chunk_positions), std::cend(chunk_positions));
+    return positions;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::assign_distinct(std::vector<T> &values, const std::vector<size_t> &positions)
+{
+    const size_t capacity = m_nodes.capacity();
+    m_nodes.reserve(positions.size());
+    count_growth(m_nodes, capacity);
+    for (auto &&position : positions)
+    {
+        emplace_node(std::move(values[position]));
+        if (m_reservedDegree != 0)
+            reserve_degree(m_nodes.back().get_adjacent_node_indices());
+    }
+    if (m_hasReverseAdjacency)
+        grow_incoming_lists(m_nodes.size());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reserve(size_type node_count, size_type edge_count)
+{
+    const size_t capacity = m_nodes.capacity();
+    m_nodes.reserve(node_count);
+    count_growth(m_nodes, capacity);
+    if constexpr (has_node_index)
+        m_nodeIndex.reserve(node_count);
+    if (!m_tombstones.empty())
+        m_tombstones.reserve(node_count);
+    if (m_hasReverseAdjacency)
+        m_incomingNodeIndices.reserve(node_count);
+
+    m_reservedDegree = node_count != 0 ? (edge_count + node_count - 1) / node_count : 0;
+    if (m_reservedDegree != 0)
+    {
+        for (auto &&node : m_nodes)
+            reserve_degree(node.get_adjacent_node_indices());
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reserve_degree(adjacency_type &indices) const
+{
+    if constexpr (requires { indices.reserve(m_reservedDegree); })
+        indices.reserve(m_reservedDegree);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::shrink_to_fit()
+{
+    m_reservedDegree = 0;
+    m_nodes.shrink_to_fit();
+    for (auto &&node : m_nodes)
+    {
+        auto &indices = node.get_adjacent_node_indices();
+        if constexpr (requires { indices.shrink_to_fit(); })
+            indices.shrink_to_fit();
+    }
+    for (auto &&indices : m_incomingNodeIndices)
+    {
+        if constexpr (requires { indices.shrink_to_fit(); })
+            indices.shrink_to_fit();
+    }
+    m_incomingNodeIndices.shrink_to_fit();
+    m_tombstones.shrink_to_fit();
+    if constexpr (has_node_index)
+        m_nodeIndex.rehash(0); // as few buckets as the load factor allows
 }
 
-template <typename T>
-void directed_graph<T>::assign(std::initializer_list<T> init)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::assign(std::initializer_list<T> init)
 {
     assign(std::begin(init), std::end(init));
 }
 
-template <typename T>
-typename directed_graph<T>::reference directed_graph<T>::operator[](size_type index)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reference directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::operator[](size_type index)
 {
     return m_nodes[index].get();
 }
 
-template <typename T>
-typename directed_graph<T>::const_reference directed_graph<T>::operator[](size_type index) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reference directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::operator[](size_type index) const
 {
     return m_nodes[index].get();
 }
 
-template <typename T>
-typename directed_graph<T>::reference directed_graph<T>::at(size_type index)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reference directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::at(size_type index)
 {
     return m_nodes.at(index).get();
 }
 
-template <typename T>
-typename directed_graph<T>::const_reference directed_graph<T>::at(size_type index) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_reference directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::at(size_type index) const
 {
     return m_nodes.at(index).get();
 }
 
-template <typename T>
-std::set<T> directed_graph<T>::get_adjacent_node_values(const T &node_value) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::adjacent_nodes_view directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::neighbors(const Key &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_nodes))
+        return adjacent_nodes_view();
+    const auto &indices = iter->get_adjacent_node_indices();
+    return adjacent_nodes_view(const_iterator_adjacent_nodes(std::cbegin(indices), std::cend(indices), this),
+                               const_iterator_adjacent_nodes(std::cend(indices), std::cend(indices), this));
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+std::set<T> directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::get_adjacent_node_values(const Key &node_value) const
 {
     auto iter = find(node_value);
     if (iter == std::end(m_nodes))
@@ -506,33 +1749,236 @@ std::set<T> directed_graph<T>::get_adjacent_node_values(const T &node_value) con
     return get_adjacent_node_values(iter->get_adjacent_node_indices());
 }
 
-template <typename T>
-bool directed_graph<T>::operator==(const directed_graph &rhs) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::operator==(const directed_graph &rhs) const
 {
-    for (auto &&node : m_nodes)
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::equal);
+    if (size() != rhs.size() || edge_count() != rhs.edge_count())
+        return false;
+
+    // Map every node to the index of its counterpart in rhs once, then compare the
+    // adjacency lists index by index. Both lists hold no duplicates and have the same
+    // number of live entries, so every mapped entry being in the rhs list makes them equal.
+    // With edge properties the matching rhs edge must also carry an equal property.
+    constexpr size_t erased = static_cast<size_t>(-1);
+    std::vector<size_t> remap(m_nodes.size(), erased);
+    for (size_t index = 0; index < m_nodes.size(); ++index)
     {
-        const auto result = rhs.find(node.get());
-        if (result == std::end(rhs.m_nodes))
+        if (is_erased(index))
+            continue;
+        const auto found = rhs.find(m_nodes[index].get());
+        if (found == std::cend(rhs.m_nodes))
             return false;
+        remap[index] = std::distance(std::cbegin(rhs.m_nodes), found);
+    }
 
-        const auto adjacent_node_values_lhs = get_adjacent_node_values(node.get_adjacent_node_indices());
-        const auto adjacent_node_values_rhs = rhs.get_adjacent_node_values(result->get_adjacent_node_indices());
-
-        if (adjacent_node_values_lhs != adjacent_node_values_rhs)
+    for (size_t index = 0; index < m_nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        const auto &indices = m_nodes[index].get_adjacent_node_indices();
+        const auto &rhs_indices = rhs.m_nodes[remap[index]].get_adjacent_node_indices();
+        if (live_degree(indices) != rhs.live_degree(rhs_indices))
             return false;
+        for (auto iter = std::cbegin(indices); iter != std::cend(indices); ++iter)
+        {
+            if (remap[*iter] == erased)
+                continue;
+            if constexpr (has_edge_properties)
+            {
+                const auto found = rhs_indices.find(remap[*iter]);
+                if (found == std::cend(rhs_indices) || !(found.property() == iter.property()))
+                    return false;
+            }
+            else if (!rhs_indices.contains(remap[*iter]))
+                return false;
+        }
     }
     return true;
 }
 
-template <typename T>
-void directed_graph<T>::swap(directed_graph &other) noexcept
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::swap(directed_graph &other) noexcept
 {
+    using std::swap;
+
     swap(m_nodes, other.m_nodes);
+    swap(m_nodeIndex, other.m_nodeIndex);
+    swap(m_tombstones, other.m_tombstones);
+    swap(m_tombstoneCount, other.m_tombstoneCount);
+    swap(m_eraseMode, other.m_eraseMode);
+    swap(m_compactionThreshold, other.m_compactionThreshold);
+    swap(m_incomingNodeIndices, other.m_incomingNodeIndices);
+    swap(m_hasReverseAdjacency, other.m_hasReverseAdjacency);
+    swap(m_reservedDegree, other.m_reservedDegree);
+    // the instrumentation counters stay with the graph object
 }
 
-template <typename T>
-bool directed_graph<T>::operator!=(const directed_graph &rhs) const
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::operator!=(const directed_graph &rhs) const
 {
     return !(*this == rhs);
 }
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::frozen_graph_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::freeze() const
+{
+    static_assert(!has_edge_properties, "freeze() would drop the edge properties, csr_graph only keeps the targets");
+    return frozen_graph_type(*this);
+}
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::enable_reverse_adjacency(bool enable)
+{
+    m_incomingNodeIndices.clear();
+    m_hasReverseAdjacency = enable;
+    if (!enable)
+    {
+        m_incomingNodeIndices.shrink_to_fit();
+        return;
+    }
+
+    grow_incoming_lists(m_nodes.size());
+    for (size_t index = 0; index < m_nodes.size(); ++index)
+    {
+        // links to tombstoned nodes are dropped here, the reverse adjacency never holds them
+        auto &outgoing = m_nodes[index].get_adjacent_node_indices();
+        for (auto iter = std::begin(outgoing); iter != std::end(outgoing);)
+        {
+            if (is_erased(*iter))
+            {
+                iter = outgoing.erase(iter);
+                continue;
+            }
+            // predecessors are visited in increasing order, so every insert appends
+            m_incomingNodeIndices[*iter].insert(std::end(m_incomingNodeIndices[*iter]), index);
+            ++iter;
+        }
+    }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::has_reverse_adjacency() const noexcept
+{
+    return m_hasReverseAdjacency;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::in_begin(const Key &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_nodes) || !m_hasReverseAdjacency) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    const auto &indices = m_incomingNodeIndices[std::distance(std::cbegin(m_nodes), iter)];
+    return const_iterator_adjacent_nodes(std::cbegin(indices), std::cend(indices), this);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::const_iterator_adjacent_nodes directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::in_end(const Key &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_nodes) || !m_hasReverseAdjacency) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    const auto &indices = m_incomingNodeIndices[std::distance(std::cbegin(m_nodes), iter)];
+    return const_iterator_adjacent_nodes(std::cend(indices), std::cend(indices), this);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename Key>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::in_degree(const Key &node_value) const noexcept
+{
+    auto iter = find(node_value);
+    if (iter == std::end(m_nodes) || !m_hasReverseAdjacency)
+        return 0;
+    return m_incomingNodeIndices[std::distance(std::cbegin(m_nodes), iter)].size();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+graph_stats directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::stats() const noexcept
+{
+    return m_instrumentation.stats();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::reset_stats() noexcept
+{
+    m_instrumentation.reset();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename From, typename To>
+bool directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::insert_edge(const From &from_node_value, const To &to_node_value, const edge_property_type &property)
+    requires has_edge_properties
+{
+    [[maybe_unused]] const auto timer = m_instrumentation.operation(graph_operation::insert_edge);
+    const auto from = find(from_node_value);
+    const auto to = find(to_node_value);
+    if (from == std::end(m_nodes) || to == std::end(m_nodes))
+    {
+        return false;
+    }
+
+    const size_t to_index = std::distance(std::begin(m_nodes), to);
+    auto &indices = from->get_adjacent_node_indices();
+    const size_t capacity = capacity_of(indices);
+    const bool inserted = indices.insert(to_index, property).second;
+    count_growth(indices, capacity);
+    if (inserted && m_hasReverseAdjacency)
+        m_incomingNodeIndices[to_index].insert(std::distance(std::begin(m_nodes), from));
+    return inserted;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename From, typename To>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::edge_property_type &directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::edge_property(const From &from_node_value, const To &to_node_value)
+    requires has_edge_properties
+{
+    const auto &self = *this;
+    return const_cast<edge_property_type &>(self.edge_property(from_node_value, to_node_value));
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+template <typename From, typename To>
+const typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::edge_property_type &directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::edge_property(const From &from_node_value, const To &to_node_value) const
+    requires has_edge_properties
+{
+    const auto from = find(from_node_value);
+    const auto to = find(to_node_value);
+    if (from != std::end(m_nodes) && to != std::end(m_nodes))
+    {
+        const auto &indices = from->get_adjacent_node_indices();
+        const auto edge = indices.find(static_cast<size_t>(std::distance(std::begin(m_nodes), to)));
+        if (edge != std::end(indices))
+            return edge.property();
+    }
+    throw std::out_of_range("directed_graph::edge_property: no such edge");
+}
+
+namespace pmr
+{
+    // directed_graph whose nodes, adjacency lists, values and index all allocate from one
+    // std::pmr::memory_resource, e.g. a std::pmr::monotonic_buffer_resource that releases
+    // the whole graph at once.
+    template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+    using directed_graph = ::directed_graph<T, Hash, KeyEqual, pmr::small_flat_set<std::size_t>, std::pmr::polymorphic_allocator<T>>;
+}
+
+// Erases every node whose value satisfies pred, like std::erase_if for the standard containers.
+// The victims are flagged first and the graph is renumbered once, see directed_graph::erase_nodes.
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation, typename Predicate>
+typename directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation>::size_type erase_if(directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation> &graph, Predicate pred)
+{
+    return graph.erase_if(pred);
+}
+
+// directed_graph with a weight (or any other property) stored column-wise with every edge,
+// see weighted_adjacency and the shortest path algorithms in graph_algorithms.hpp.
+template <typename T, typename Weight = double, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+using weighted_directed_graph = directed_graph<T, Hash, KeyEqual, weighted_adjacency<Weight>>;
+
+// directed_graph for dense graphs: every adjacency list is a row of bits, see bitset_adjacency.
+// Convert from and to the sparse default with the explicit converting constructor.
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+using dense_directed_graph = directed_graph<T, Hash, KeyEqual, bitset_adjacency>;
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef EXECUTION_DISPATCH_HPP
+#define EXECUTION_DISPATCH_HPP
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+// Lets the graph code take an optional C++17 execution policy without including <execution>
+// (which drags in the parallel backend for every user). serial_policy runs the plain std algorithm,
+// any other policy is forwarded to the std overload taking an execution policy, so callers
+// that pass std::execution::par include <execution> themselves.
+struct serial_policy
+{
+};
+
+namespace execution_dispatch
+{
+    template <typename ExecutionPolicy>
+    inline constexpr bool is_serial_v = std::is_same_v<std::remove_cvref_t<ExecutionPolicy>, serial_policy>;
+
+    template <typename ExecutionPolicy, typename Iter, typename Compare>
+    void sort(ExecutionPolicy &&policy, Iter first, Iter last, Compare comp)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            std::sort(first, last, comp);
+        else
+            std::sort(std::forward<ExecutionPolicy>(policy), first, last, comp);
+    }
+
+    template <typename ExecutionPolicy, typename Iter>
+    Iter unique(ExecutionPolicy &&policy, Iter first, Iter last)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            return std::unique(first, last);
+        else
+            return std::unique(std::forward<ExecutionPolicy>(policy), first, last);
+    }
+
+    template <typename ExecutionPolicy, typename Iter, typename Predicate>
+    Iter remove_if(ExecutionPolicy &&policy, Iter first, Iter last, Predicate pred)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            return std::remove_if(first, last, pred);
+        else
+            return std::remove_if(std::forward<ExecutionPolicy>(policy), first, last, pred);
+    }
+
+    template <typename ExecutionPolicy, typename InputIter, typename OutputIter, typename UnaryOp>
+    OutputIter transform(ExecutionPolicy &&policy, InputIter first, InputIter last, OutputIter output, UnaryOp op)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            return std::transform(first, last, output, op);
+        else
+            return std::transform(std::forward<ExecutionPolicy>(policy), first, last, output, op);
+    }
+
+    template <typename ExecutionPolicy, typename Iter, typename Function>
+    void for_each(ExecutionPolicy &&policy, Iter first, Iter last, Function f)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            std::for_each(first, last, f);
+        else
+            std::for_each(std::forward<ExecutionPolicy>(policy), first, last, f);
+    }
+
+    template <typename ExecutionPolicy, typename Iter, typename U, typename BinaryOp, typename UnaryOp>
+    U transform_reduce(ExecutionPolicy &&policy, Iter first, Iter last, U init, BinaryOp reduce, UnaryOp transform)
+    {
+        if constexpr (is_serial_v<ExecutionPolicy>)
+            return std::transform_reduce(first, last, init, reduce, transform);
+        else
+            return std::transform_reduce(std::forward<ExecutionPolicy>(policy), first, last, init, reduce, transform);
+    }
+}
+#endif
@@ -0,0 +1,1181 @@
+#ifndef GRAPH_ALGORITHMS_HPP
+#define GRAPH_ALGORITHMS_HPP
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "directed_graph.hpp"
+#include "execution_dispatch.hpp"
+
+// Generic graph algorithms working on node indices. They accept a directed_graph, which may
+// hold tombstoned nodes that are skipped, as well as the read-only csr_graph and mapped_graph.
+// Traversals are iterative with work arrays sized once per call, so deep graphs cannot overflow
+// the stack and nothing is allocated per node.
+
+namespace graph_algorithms_detail
+{
+    // Number of node slots, including tombstoned ones: valid indices are 0 .. slot_count - 1.
+    template <typename Graph>
+    std::size_t slot_count(const Graph &graph) noexcept
+    {
+        if constexpr (requires { graph.m_nodes; })
+            return graph.m_nodes.size();
+        else
+            return graph.size();
+    }
+
+    template <typename Graph>
+    bool is_live(const Graph &graph, std::size_t index) noexcept
+    {
+        if constexpr (requires { graph.is_erased(index); })
+            return !graph.is_erased(index);
+        else
+            return true;
+    }
+
+    // The adjacency indices of a node, in place for directed_graph and as a view otherwise.
+    template <typename Graph>
+    decltype(auto) adjacent(const Graph &graph, std::size_t index) noexcept
+    {
+        if constexpr (requires { graph.m_nodes; })
+            return (graph.m_nodes[index].get_adjacent_node_indices());
+        else
+            return graph.get_adjacent_node_indices(index);
+    }
+
+    template <typename Graph>
+    decltype(auto) value_at(const Graph &graph, std::size_t index)
+    {
+        if constexpr (requires { graph.m_nodes; })
+            return (graph.m_nodes[index].get());
+        else if constexpr (requires { graph.m_values; })
+            return (graph.m_values[index]);
+        else
+            return graph[index];
+    }
+
+    // Reversed edges of the live nodes in compressed sparse row form.
+    struct reversed_edges
+    {
+        std::vector<std::size_t> m_offsets;
+        std::vector<std::size_t> m_sources;
+    };
+
+    // Calls f(first, last) for consecutive chunks of [0, count) as separate tasks under policy.
+    template <typename ExecutionPolicy, typename Function>
+    void for_each_chunk(ExecutionPolicy &&policy, std::size_t count, std::size_t chunk_size, Function f)
+    {
+        if (count <= chunk_size)
+        {
+            // not worth a task, e.g. the many small frontiers of a deep search
+            if (count != 0)
+                f(std::size_t{0}, count);
+            return;
+        }
+        const std::size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+        std::vector<std::size_t> chunk_ids(chunk_count);
+        std::iota(std::begin(chunk_ids), std::end(chunk_ids), std::size_t{0});
+        execution_dispatch::for_each(policy, std::begin(chunk_ids), std::end(chunk_ids), [&](std::size_t chunk)
+                                     {
+            const std::size_t first = chunk * chunk_size;
+            f(first, std::min(first + chunk_size, count)); });
+    }
+
+    // Edge property type of a graph, no_edge_property for graphs that keep none.
+    template <typename Graph>
+    struct graph_edge_property
+    {
+        using type = no_edge_property;
+    };
+
+    template <typename Graph>
+        requires requires { typename Graph::edge_property_type; }
+    struct graph_edge_property<Graph>
+    {
+        using type = typename Graph::edge_property_type;
+    };
+
+    // The weight of the edge an adjacency iterator points to.
+    template <typename Iterator, typename Weight>
+    decltype(auto) weight_of(const Iterator &it, const Weight &weight)
+    {
+        if constexpr (requires { it.property(); })
+            return weight(it.property());
+        else
+            return weight(no_edge_property{});
+    }
+}
+
+// Default edge weight for the shortest path algorithms: the edge property itself, e.g. the
+// Weight of a weighted_directed_graph, and 1 for every edge of a graph without edge properties.
+struct edge_weight
+{
+    template <typename Property>
+    decltype(auto) operator()(const Property &property) const noexcept
+    {
+        if constexpr (std::is_same_v<Property, no_edge_property>)
+            return std::size_t{1};
+        else
+            return (property);
+    }
+};
+
+// Type of the distances computed with the given weight functor.
+template <typename Graph, typename Weight = edge_weight>
+using path_distance_t = std::remove_cvref_t<std::invoke_result_t<const Weight &, const typename graph_algorithms_detail::graph_edge_property<Graph>::type &>>;
+
+// Node values for the given node indices, e.g. to turn the result of an algorithm into values.
+template <typename Graph>
+std::vector<typename Graph::value_type> values_of(const Graph &graph, const std::vector<std::size_t> &indices)
+{
+    std::vector<typename Graph::value_type> values;
+    values.reserve(indices.size());
+    for (auto &&index : indices)
+        values.push_back(graph_algorithms_detail::value_at(graph, index));
+    return values;
+}
+
+struct topological_order
+{
+    // Node indices such that every edge goes from an earlier to a later node. Empty if there is a cycle.
+    std::vector<std::size_t> order;
+    // Node indices c0, c1, ..., ck of a cycle c0 -> c1 -> ... -> ck -> c0, empty if the graph is acyclic.
+    std::vector<std::size_t> cycle;
+
+    bool is_dag() const noexcept { return cycle.empty(); }
+};
+
+struct bfs_tree
+{
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Hops from the nearest source, npos for nodes that cannot be reached.
+    std::vector<std::size_t> distance;
+    // Predecessor on a shortest path from a source, the node itself for sources, npos if unreached.
+    std::vector<std::size_t> parent;
+};
+
+template <typename Distance>
+struct shortest_path_tree
+{
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    static constexpr Distance unreachable = std::numeric_limits<Distance>::has_infinity ? std::numeric_limits<Distance>::infinity() : std::numeric_limits<Distance>::max();
+
+    // Length of a shortest path from the nearest source, unreachable for nodes that cannot be reached.
+    std::vector<Distance> distance;
+    // Predecessor on a shortest path from a source, the node itself for sources, npos if unreached.
+    std::vector<std::size_t> parent;
+};
+
+struct strong_components
+{
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Component id of every node index, npos for tombstoned nodes.
+    std::vector<std::size_t> component;
+    // Ids are 0 .. count - 1.
+    std::size_t count = 0;
+};
+
+// Topological sort by iterative depth-first search in O(V + E). Stops at the first cycle found
+// and reports it instead. Nodes are visited in index order, so the order is deterministic.
+template <typename Graph>
+topological_order topological_sort(const Graph &graph);
+
+// Same, returning node values. Throws std::invalid_argument if the graph has a cycle.
+template <typename Graph>
+std::vector<typename Graph::value_type> topological_sort_values(const Graph &graph);
+
+// Strongly connected components by iterative Tarjan in O(V + E). Component ids are a topological
+// order of the condensation: every edge between two components goes to a higher id.
+template <typename Graph>
+strong_components strongly_connected_components(const Graph &graph);
+
+// Same, for large graphs. In parallel passes under the given policy, nodes without incoming or
+// outgoing edges are trimmed off as components of their own and the component of a pivot of
+// high degree, usually the giant one, is found by forward-backward search; Tarjan then runs on
+// what is left. Needs O(V + E) extra memory for the reversed edges. The ids are not ordered.
+template <typename ExecutionPolicy, typename Graph>
+strong_components strongly_connected_components(ExecutionPolicy &&policy, const Graph &graph);
+
+// Breadth-first search from one or several sources, given as node indices. Throws
+// std::out_of_range if a source is not a live node. Sequential top-down search with one queue.
+template <typename Graph>
+bfs_tree breadth_first_search(const Graph &graph, std::size_t source);
+template <typename Graph>
+bfs_tree breadth_first_search(const Graph &graph, const std::vector<std::size_t> &sources);
+
+// Direction-optimizing breadth-first search with every level expanded in parallel chunks under
+// the given policy. Small frontiers are expanded top-down from a queue; once the frontier's edges
+// outweigh those left to explore, the search goes bottom-up, every unreached node scanning its
+// incoming edges for a frontier node, until the frontier shrinks again. The reversed edges this
+// needs take O(V + E) memory and are built once per engine, so keep the engine around for repeated
+// searches; the graph must not change meanwhile. Distances match the sequential search, parents
+// may differ between runs.
+template <typename Graph>
+class bfs_engine
+{
+public:
+    explicit bfs_engine(const Graph &graph);
+
+    template <typename ExecutionPolicy>
+    bfs_tree search(ExecutionPolicy &&policy, std::size_t source) const;
+    template <typename ExecutionPolicy>
+    bfs_tree search(ExecutionPolicy &&policy, const std::vector<std::size_t> &sources) const;
+
+private:
+    const Graph &m_graph;
+    graph_algorithms_detail::reversed_edges m_reversed;
+};
+
+// One search with a temporary bfs_engine.
+template <typename ExecutionPolicy, typename Graph>
+bfs_tree breadth_first_search(ExecutionPolicy &&policy, const Graph &graph, std::size_t source);
+template <typename ExecutionPolicy, typename Graph>
+bfs_tree breadth_first_search(ExecutionPolicy &&policy, const Graph &graph, const std::vector<std::size_t> &sources);
+
+// Dijkstra's shortest paths from one or several sources, given as node indices, in
+// O((V + E) log V). weight maps the property of an edge to its length, see edge_weight. Throws
+// std::out_of_range if a source is not a live node and std::invalid_argument on a negative weight.
+// The queue is an indexed 4-ary heap of (distance, node) pairs in one array: it is shallower than a
+// binary heap and the children of a node share a cache line.
+template <typename Graph, typename Weight = edge_weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> dijkstra(const Graph &graph, std::size_t source, const Weight &weight = {});
+template <typename Graph, typename Weight = edge_weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> dijkstra(const Graph &graph, const std::vector<std::size_t> &sources, const Weight &weight = {});
+
+// Same distances by delta-stepping (Meyer and Sanders), for large graphs. Nodes are kept in
+// buckets of width delta by distance and all nodes of the lowest bucket are relaxed at once:
+// the relaxation requests of their edges are generated in parallel chunks under the given policy
+// and then applied in one sequential pass, so no distance is ever written concurrently. Edges no
+// longer than delta are relaxed until the bucket stays empty, longer ones once per settled node.
+// A delta of 0 picks the average edge weight. Parents may differ from dijkstra on ties.
+template <typename ExecutionPolicy, typename Graph, typename Weight = edge_weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> delta_stepping(ExecutionPolicy &&policy, const Graph &graph, std::size_t source,
+                                                                  path_distance_t<Graph, Weight> delta = {}, const Weight &weight = {});
+template <typename ExecutionPolicy, typename Graph, typename Weight = edge_weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> delta_stepping(ExecutionPolicy &&policy, const Graph &graph, const std::vector<std::size_t> &sources,
+                                                                  path_distance_t<Graph, Weight> delta = {}, const Weight &weight = {});
+
+// The condensation as a directed_graph whose node values and indices are the component ids,
+// with an edge between two components whenever an edge of graph connects them.
+template <typename Graph>
+directed_graph<std::size_t> condensation(const Graph &graph, const strong_components &components);
+
+template <typename Graph>
+topological_order topological_sort(const Graph &graph)
+{
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::is_live;
+    using adjacency_iterator = decltype(std::cbegin(adjacent(graph, 0)));
+
+    enum : std::uint8_t
+    {
+        unvisited,
+        on_path,
+        done
+    };
+
+    // One frame per node on the current DFS path: the node and the next adjacency entry to visit.
+    struct frame
+    {
+        std::size_t m_node;
+        adjacency_iterator m_next;
+        adjacency_iterator m_last;
+    };
+
+    const std::size_t count = graph_algorithms_detail::slot_count(graph);
+    std::vector<std::uint8_t> state(count, unvisited);
+    std::vector<frame> path;
+    path.reserve(count);
+    topological_order result;
+    result.order.reserve(count);
+
+    for (std::size_t root = 0; root < count; ++root)
+    {
+        if (state[root] != unvisited || !is_live(graph, root))
+            continue;
+        const auto &root_adjacent = adjacent(graph, root);
+        path.push_back({root, std::cbegin(root_adjacent), std::cend(root_adjacent)});
+        state[root] = on_path;
+        while (!path.empty())
+        {
+            auto &top = path.back();
+            if (top.m_next == top.m_last)
+            {
+                // finished nodes come out in reverse topological order
+                state[top.m_node] = done;
+                result.order.push_back(top.m_node);
+                path.pop_back();
+                continue;
+            }
+            const std::size_t target = *top.m_next++;
+            if (!is_live(graph, target) || state[target] == done)
+                continue;
+            if (state[target] == on_path)
+            {
+                // the path from target to the top of the stack closes a cycle
+                auto first = std::end(path);
+                while ((--first)->m_node != target)
+                    ;
+                for (; first != std::end(path); ++first)
+                    result.cycle.push_back(first->m_node);
+                result.order.clear();
+                return result;
+            }
+            const auto &target_adjacent = adjacent(graph, target);
+            path.push_back({target, std::cbegin(target_adjacent), std::cend(target_adjacent)});
+            state[target] = on_path;
+        }
+    }
+    std::reverse(std::begin(result.order), std::end(result.order));
+    return result;
+}
+
+template <typename Graph>
+std::vector<typename Graph::value_type> topological_sort_values(const Graph &graph)
+{
+    const auto sorted = topological_sort(graph);
+    if (!sorted.is_dag())
+        throw std::invalid_argument("topological_sort_values: the graph has a cycle");
+    return values_of(graph, sorted.order);
+}
+
+namespace graph_algorithms_detail
+{
+    // Iterative Tarjan over the live nodes whose component is still npos, ignoring edges to nodes
+    // that already have one. Those must be whole components, so the rest splits the same way.
+    // New components get ids from components.count upwards, in reverse topological order.
+    template <typename Graph>
+    void tarjan(const Graph &graph, strong_components &components)
+    {
+        using adjacency_iterator = decltype(std::cbegin(adjacent(graph, 0)));
+        constexpr std::size_t npos = strong_components::npos;
+
+        struct frame
+        {
+            std::size_t m_node;
+            adjacency_iterator m_next;
+            adjacency_iterator m_last;
+        };
+
+        auto &component = components.component;
+        const std::size_t count = slot_count(graph);
+        // discovery order and lowest discovery order reachable through the subtree
+        std::vector<std::size_t> order(count, npos);
+        std::vector<std::size_t> low(count);
+        // visited nodes without a component yet, they are still on the Tarjan stack
+        std::vector<std::size_t> open;
+        open.reserve(count);
+        std::vector<frame> path;
+        path.reserve(count);
+        std::size_t discovered = 0;
+
+        const auto visit = [&](std::size_t node)
+        {
+            order[node] = low[node] = discovered++;
+            open.push_back(node);
+            const auto &node_adjacent = adjacent(graph, node);
+            path.push_back({node, std::cbegin(node_adjacent), std::cend(node_adjacent)});
+        };
+
+        for (std::size_t root = 0; root < count; ++root)
+        {
+            if (component[root] != npos || order[root] != npos || !is_live(graph, root))
+                continue;
+            visit(root);
+            while (!path.empty())
+            {
+                auto &top = path.back();
+                if (top.m_next != top.m_last)
+                {
+                    const std::size_t target = *top.m_next++;
+                    if (!is_live(graph, target) || component[target] != npos)
+                        continue;
+                    if (order[target] == npos)
+                        visit(target);
+                    else
+                        low[top.m_node] = std::min(low[top.m_node], order[target]);
+                    continue;
+                }
+
+                const std::size_t node = top.m_node;
+                path.pop_back();
+                if (!path.empty())
+                    low[path.back().m_node] = std::min(low[path.back().m_node], low[node]);
+                if (low[node] == order[node])
+                {
+                    // node is the root of a component made of everything above it on the stack
+                    std::size_t member;
+                    do
+                    {
+                        member = open.back();
+                        open.pop_back();
+                        component[member] = components.count;
+                    } while (member != node);
+                    ++components.count;
+                }
+            }
+        }
+    }
+
+    // Reversed edges of the live nodes, built sequentially on purpose: counting edges into shared slots needs an atomic
+    // read-modify-write per edge, and on random targets those cost more than the pass itself.
+    template <typename Graph>
+    reversed_edges reverse_edges(const Graph &graph)
+    {
+        const std::size_t count = slot_count(graph);
+        reversed_edges reversed;
+        reversed.m_offsets.assign(count + 1, 0);
+        for (std::size_t node = 0; node < count; ++node)
+        {
+            if (!is_live(graph, node))
+                continue;
+            for (auto &&target : adjacent(graph, node))
+            {
+                if (is_live(graph, target))
+                    ++reversed.m_offsets[target + 1];
+            }
+        }
+        std::partial_sum(std::cbegin(reversed.m_offsets), std::cend(reversed.m_offsets), std::begin(reversed.m_offsets));
+
+        reversed.m_sources.resize(reversed.m_offsets[count]);
+        std::vector<std::size_t> cursors(std::cbegin(reversed.m_offsets), std::cend(reversed.m_offsets) - 1);
+        for (std::size_t node = 0; node < count; ++node)
+        {
+            if (!is_live(graph, node))
+                continue;
+            for (auto &&target : adjacent(graph, node))
+            {
+                if (is_live(graph, target))
+                    reversed.m_sources[cursors[target]++] = node;
+            }
+        }
+        return reversed;
+    }
+}
+
+template <typename Graph>
+strong_components strongly_connected_components(const Graph &graph)
+{
+    strong_components components;
+    components.component.assign(graph_algorithms_detail::slot_count(graph), strong_components::npos);
+    graph_algorithms_detail::tarjan(graph, components);
+    // Tarjan finishes sink components first, flip the ids into topological order
+    for (auto &&id : components.component)
+    {
+        if (id != strong_components::npos)
+            id = components.count - 1 - id;
+    }
+    return components;
+}
+
+template <typename ExecutionPolicy, typename Graph>
+strong_components strongly_connected_components(ExecutionPolicy &&policy, const Graph &graph)
+{
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::for_each_chunk;
+    using graph_algorithms_detail::is_live;
+    constexpr std::size_t chunk_size = 4096;
+    // trimming peels one layer of a chain per pass at worst, Tarjan takes whatever is left
+    constexpr int max_trim_passes = 8;
+    enum : std::uint8_t
+    {
+        trimmed = 1,
+        forward = 2,
+        backward = 4
+    };
+
+    const std::size_t count = graph_algorithms_detail::slot_count(graph);
+    const auto reversed = graph_algorithms_detail::reverse_edges(graph);
+    std::vector<std::atomic<std::uint8_t>> flags(count);
+
+    // A node that no other untrimmed node reaches, or that reaches none, is a component of its own.
+    for (int pass = 0; pass < max_trim_passes; ++pass)
+    {
+        std::atomic<bool> changed{false};
+        for_each_chunk(policy, count, chunk_size, [&](std::size_t first, std::size_t last)
+                       {
+            for (std::size_t node = first; node < last; ++node)
+            {
+                if (!is_live(graph, node) || flags[node].load(std::memory_order_relaxed) & trimmed)
+                    continue;
+                const auto untrimmed = [&](std::size_t other)
+                { return other != node && is_live(graph, other) && !(flags[other].load(std::memory_order_relaxed) & trimmed); };
+                const auto &out = adjacent(graph, node);
+                const auto in_first = std::cbegin(reversed.m_sources) + static_cast<std::ptrdiff_t>(reversed.m_offsets[node]);
+                const auto in_last = std::cbegin(reversed.m_sources) + static_cast<std::ptrdiff_t>(reversed.m_offsets[node + 1]);
+                if (std::none_of(std::cbegin(out), std::cend(out), untrimmed) || std::none_of(in_first, in_last, untrimmed))
+                {
+                    flags[node].fetch_or(trimmed, std::memory_order_relaxed);
+                    changed.store(true, std::memory_order_relaxed);
+                }
+            } });
+        if (!changed.load())
+            break;
+    }
+
+    // The pivot with the most in * out edges most likely lies in the largest component.
+    std::size_t pivot = strong_components::npos;
+    std::size_t best_score = 0;
+    for (std::size_t node = 0; node < count; ++node)
+    {
+        if (!is_live(graph, node) || flags[node].load(std::memory_order_relaxed) & trimmed)
+            continue;
+        const std::size_t score = (reversed.m_offsets[node + 1] - reversed.m_offsets[node] + 1) * (std::size(adjacent(graph, node)) + 1);
+        if (pivot == strong_components::npos || score > best_score)
+        {
+            pivot = node;
+            best_score = score;
+        }
+    }
+
+    if (pivot != strong_components::npos)
+    {
+        // Level-synchronous search from the pivot, each level expanded in parallel chunks. The backward
+        // search only walks nodes the forward search reached, which leaves exactly the pivot's component.
+        std::vector<std::size_t> frontier;
+        std::vector<std::size_t> next(count);
+        std::mutex next_mutex;
+        const auto search = [&](std::uint8_t direction)
+        {
+            frontier.assign(1, pivot);
+            flags[pivot].fetch_or(direction, std::memory_order_relaxed);
+            while (!frontier.empty())
+            {
+                std::size_t next_size = 0;
+                for_each_chunk(policy, frontier.size(), chunk_size, [&](std::size_t first, std::size_t last)
+                               {
+                    std::vector<std::size_t> found;
+                    const auto reach = [&](std::size_t target)
+                    {
+                        if (!is_live(graph, target))
+                            return;
+                        const std::uint8_t target_flags = flags[target].load(std::memory_order_relaxed);
+                        if (target_flags & (trimmed | direction) || (direction == backward && !(target_flags & forward)))
+                            return;
+                        if (!(flags[target].fetch_or(direction, std::memory_order_relaxed) & direction))
+                            found.push_back(target);
+                    };
+                    for (std::size_t position = first; position < last; ++position)
+                    {
+                        const std::size_t node = frontier[position];
+                        if (direction == forward)
+                        {
+                            for (auto &&target : adjacent(graph, node))
+                                reach(target);
+                        }
+                        else
+                        {
+                            for (std::size_t edge = reversed.m_offsets[node]; edge < reversed.m_offsets[node + 1]; ++edge)
+                                reach(reversed.m_sources[edge]);
+                        }
+                    }
+                    std::lock_guard<std::mutex> lock(next_mutex);
+                    std::copy(std::cbegin(found), std::cend(found), std::begin(next) + static_cast<std::ptrdiff_t>(next_size));
+                    next_size += found.size(); });
+                frontier.assign(std::cbegin(next), std::cbegin(next) + static_cast<std::ptrdiff_t>(next_size));
+            }
+        };
+        search(forward);
+        search(backward);
+    }
+
+    strong_components components;
+    components.component.assign(count, strong_components::npos);
+    std::size_t pivot_component = strong_components::npos;
+    for (std::size_t node = 0; node < count; ++node)
+    {
+        if (!is_live(graph, node))
+            continue;
+        const std::uint8_t node_flags = flags[node].load(std::memory_order_relaxed);
+        if (node_flags & trimmed)
+        {
+            components.component[node] = components.count++;
+        }
+        else if ((node_flags & (forward | backward)) == (forward | backward))
+        {
+            if (pivot_component == strong_components::npos)
+                pivot_component = components.count++;
+            components.component[node] = pivot_component;
+        }
+    }
+    graph_algorithms_detail::tarjan(graph, components);
+    return components;
+}
+
+template <typename Graph>
+directed_graph<std::size_t> condensation(const Graph &graph, const strong_components &components)
+{
+    using graph_algorithms_detail::adjacent;
+    constexpr std::size_t npos = strong_components::npos;
+
+    directed_graph<std::size_t> result;
+    for (std::size_t id = 0; id < components.count; ++id)
+        result.insert(id);
+
+    // group the nodes by component (counting sort), then collect the distinct targets of each group
+    const std::size_t count = components.component.size();
+    std::vector<std::size_t> offsets(components.count + 1, 0);
+    for (auto &&id : components.component)
+    {
+        if (id != npos)
+            ++offsets[id + 1];
+    }
+    std::partial_sum(std::cbegin(offsets), std::cend(offsets), std::begin(offsets));
+    std::vector<std::size_t> members(offsets[components.count]);
+    {
+        std::vector<std::size_t> cursors(std::cbegin(offsets), std::cend(offsets) - 1);
+        for (std::size_t node = 0; node < count; ++node)
+        {
+            if (components.component[node] != npos)
+                members[cursors[components.component[node]]++] = node;
+        }
+    }
+
+    // seen[c] == id + 1 once c has been added as a target of component id
+    std::vector<std::size_t> seen(components.count, 0);
+    std::vector<std::size_t> targets;
+    for (std::size_t id = 0; id < components.count; ++id)
+    {
+        targets.clear();
+        for (std::size_t member = offsets[id]; member < offsets[id + 1]; ++member)
+        {
+            for (auto &&target : adjacent(graph, members[member]))
+            {
+                const std::size_t target_id = components.component[target];
+                if (target_id == npos || target_id == id || seen[target_id] == id + 1)
+                    continue;
+                seen[target_id] = id + 1;
+                targets.push_back(target_id);
+            }
+        }
+        std::sort(std::begin(targets), std::end(targets));
+        auto &indices = result.m_nodes[id].get_adjacent_node_indices();
+        if constexpr (requires { indices.assign_sorted_unique(std::cbegin(targets), std::cend(targets)); })
+        {
+            indices.assign_sorted_unique(std::cbegin(targets), std::cend(targets));
+        }
+        else
+        {
+            for (auto &&target : targets)
+                indices.insert(std::end(indices), target);
+        }
+    }
+    return result;
+}
+
+namespace graph_algorithms_detail
+{
+    // Result with every node unreached and the sources at distance 0, the distinct sources go to frontier.
+    template <typename Graph>
+    bfs_tree bfs_start(const Graph &graph, const std::vector<std::size_t> &sources, std::vector<std::size_t> &frontier)
+    {
+        const std::size_t count = slot_count(graph);
+        bfs_tree tree;
+        tree.distance.assign(count, bfs_tree::npos);
+        tree.parent.assign(count, bfs_tree::npos);
+        for (auto &&source : sources)
+        {
+            if (source >= count || !is_live(graph, source))
+                throw std::out_of_range("breadth_first_search: source is not a node of the graph");
+            tree.distance[source] = 0;
+            tree.parent[source] = source;
+        }
+        frontier.assign(std::cbegin(sources), std::cend(sources));
+        std::sort(std::begin(frontier), std::end(frontier));
+        frontier.erase(std::unique(std::begin(frontier), std::end(frontier)), std::end(frontier));
+        return tree;
+    }
+}
+
+template <typename Graph>
+bfs_tree breadth_first_search(const Graph &graph, std::size_t source)
+{
+    return breadth_first_search(graph, std::vector<std::size_t>{source});
+}
+
+template <typename Graph>
+bfs_tree breadth_first_search(const Graph &graph, const std::vector<std::size_t> &sources)
+{
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::is_live;
+
+    // every node enters the queue once, so a vector read from the front is the whole queue
+    std::vector<std::size_t> queue;
+    bfs_tree tree = graph_algorithms_detail::bfs_start(graph, sources, queue);
+    queue.reserve(tree.distance.size());
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        const std::size_t node = queue[head];
+        for (auto &&target : adjacent(graph, node))
+        {
+            if (tree.parent[target] != bfs_tree::npos || !is_live(graph, target))
+                continue;
+            tree.parent[target] = node;
+            tree.distance[target] = tree.distance[node] + 1;
+            queue.push_back(target);
+        }
+    }
+    return tree;
+}
+
+template <typename Graph>
+bfs_engine<Graph>::bfs_engine(const Graph &graph) : m_graph(graph), m_reversed(graph_algorithms_detail::reverse_edges(graph)) {}
+
+template <typename Graph>
+template <typename ExecutionPolicy>
+bfs_tree bfs_engine<Graph>::search(ExecutionPolicy &&policy, std::size_t source) const
+{
+    return search(std::forward<ExecutionPolicy>(policy), std::vector<std::size_t>{source});
+}
+
+template <typename Graph>
+template <typename ExecutionPolicy>
+bfs_tree bfs_engine<Graph>::search(ExecutionPolicy &&policy, const std::vector<std::size_t> &sources) const
+{
+    const Graph &graph = m_graph;
+    const auto &reversed = m_reversed;
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::for_each_chunk;
+    using graph_algorithms_detail::is_live;
+    constexpr std::size_t chunk_size = 4096;
+    // switching thresholds from Beamer et al., "Direction-Optimizing Breadth-First Search"
+    constexpr std::size_t alpha = 14;
+    constexpr std::size_t beta = 24;
+
+    // The frontier is kept as a queue while going top-down and as a byte map going bottom-up.
+    std::vector<std::size_t> frontier;
+    bfs_tree tree = graph_algorithms_detail::bfs_start(graph, sources, frontier);
+    const std::size_t count = tree.distance.size();
+    const auto out_degree = [&](std::size_t node)
+    { return static_cast<std::size_t>(std::size(adjacent(graph, node))); };
+
+    std::vector<std::size_t> next(count);
+    std::vector<std::uint8_t> frontier_map;
+    std::vector<std::uint8_t> next_map;
+    std::mutex next_mutex;
+
+    // edges out of the frontier, and out of the nodes not reached yet
+    std::size_t frontier_edges = 0;
+    for (auto &&node : frontier)
+        frontier_edges += out_degree(node);
+    std::size_t unexplored_edges = reversed.m_sources.size() - std::min(reversed.m_sources.size(), frontier_edges);
+    std::size_t frontier_size = frontier.size();
+    bool bottom_up = false;
+
+    for (std::size_t level = 0; frontier_size != 0; ++level)
+    {
+        if (!bottom_up && frontier_edges > unexplored_edges / alpha)
+        {
+            // the frontier is large enough that checking the unreached nodes is cheaper
+            bottom_up = true;
+            frontier_map.assign(count, 0);
+            next_map.assign(count, 0);
+            for (auto &&node : frontier)
+                frontier_map[node] = 1;
+        }
+        else if (bottom_up && frontier_size < count / beta)
+        {
+            bottom_up = false;
+            frontier.clear();
+            for (std::size_t node = 0; node < count; ++node)
+            {
+                if (frontier_map[node])
+                    frontier.push_back(node);
+            }
+        }
+
+        std::atomic<std::size_t> next_size{0};
+        std::atomic<std::size_t> next_edges{0};
+        if (bottom_up)
+        {
+            // every unreached node only writes its own entries, no two chunks touch the same data
+            for_each_chunk(policy, count, chunk_size, [&](std::size_t first, std::size_t last)
+                           {
+                std::size_t found = 0;
+                std::size_t found_edges = 0;
+                for (std::size_t node = first; node < last; ++node)
+                {
+                    next_map[node] = 0;
+                    if (tree.parent[node] != bfs_tree::npos || !is_live(graph, node))
+                        continue;
+                    for (std::size_t edge = reversed.m_offsets[node]; edge < reversed.m_offsets[node + 1]; ++edge)
+                    {
+                        const std::size_t source = reversed.m_sources[edge];
+                        if (frontier_map[source])
+                        {
+                            tree.parent[node] = source;
+                            tree.distance[node] = level + 1;
+                            next_map[node] = 1;
+                            ++found;
+                            found_edges += out_degree(node);
+                            break;
+                        }
+                    }
+                }
+                next_size.fetch_add(found, std::memory_order_relaxed);
+                next_edges.fetch_add(found_edges, std::memory_order_relaxed); });
+            frontier_map.swap(next_map);
+        }
+        else
+        {
+            // nodes are claimed by setting their parent, the first frontier node to get there wins
+            for_each_chunk(policy, frontier.size(), chunk_size, [&](std::size_t first, std::size_t last)
+                           {
+                std::vector<std::size_t> found;
+                std::size_t found_edges = 0;
+                for (std::size_t position = first; position < last; ++position)
+                {
+                    const std::size_t node = frontier[position];
+                    for (auto &&target : adjacent(graph, node))
+                    {
+                        if (!is_live(graph, target))
+                            continue;
+                        std::atomic_ref<std::size_t> parent(tree.parent[target]);
+                        std::size_t unclaimed = bfs_tree::npos;
+                        if (parent.load(std::memory_order_relaxed) != bfs_tree::npos ||
+                            !parent.compare_exchange_strong(unclaimed, node, std::memory_order_relaxed))
+                            continue;
+                        tree.distance[target] = level + 1;
+                        found.push_back(target);
+                        found_edges += out_degree(target);
+                    }
+                }
+                next_edges.fetch_add(found_edges, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(next_mutex);
+                const std::size_t at = next_size.fetch_add(found.size(), std::memory_order_relaxed);
+                std::copy(std::cbegin(found), std::cend(found), std::begin(next) + static_cast<std::ptrdiff_t>(at)); });
+            frontier.assign(std::cbegin(next), std::cbegin(next) + static_cast<std::ptrdiff_t>(next_size.load()));
+        }
+        frontier_size = next_size.load();
+        frontier_edges = next_edges.load();
+        unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+    }
+    return tree;
+}
+
+template <typename ExecutionPolicy, typename Graph>
+bfs_tree breadth_first_search(ExecutionPolicy &&policy, const Graph &graph, std::size_t source)
+{
+    return bfs_engine<Graph>(graph).search(std::forward<ExecutionPolicy>(policy), source);
+}
+
+template <typename ExecutionPolicy, typename Graph>
+bfs_tree breadth_first_search(ExecutionPolicy &&policy, const Graph &graph, const std::vector<std::size_t> &sources)
+{
+    return bfs_engine<Graph>(graph).search(std::forward<ExecutionPolicy>(policy), sources);
+}
+
+namespace graph_algorithms_detail
+{
+    // Min-heap of (distance, node) pairs with arity 4 that knows where every node sits, so that
+    // the distance of a queued node can be lowered in place.
+    template <typename Distance>
+    class d_ary_heap
+    {
+    public:
+        static constexpr std::size_t arity = 4;
+
+        explicit d_ary_heap(std::size_t node_count) : m_position(node_count, npos) {}
+
+        bool empty() const noexcept { return m_entries.empty(); }
+
+        // Queues node at distance, or moves it up if it is queued at a larger distance.
+        void push_or_decrease(std::size_t node, Distance distance)
+        {
+            std::size_t at = m_position[node];
+            if (at == npos)
+            {
+                at = m_entries.size();
+                m_entries.emplace_back(distance, node);
+            }
+            else if (distance < m_entries[at].first)
+                m_entries[at].first = distance;
+            else
+                return;
+            sift_up(at);
+        }
+
+        std::pair<Distance, std::size_t> pop()
+        {
+            const auto top = m_entries.front();
+            m_position[top.second] = npos;
+            const auto last = m_entries.back();
+            m_entries.pop_back();
+            if (!m_entries.empty())
+            {
+                m_entries.front() = last;
+                sift_down(0);
+            }
+            return top;
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        std::vector<std::pair<Distance, std::size_t>> m_entries;
+        std::vector<std::size_t> m_position;
+
+        void sift_up(std::size_t at)
+        {
+            const auto entry = m_entries[at];
+            while (at != 0)
+            {
+                const std::size_t parent = (at - 1) / arity;
+                if (!(entry.first < m_entries[parent].first))
+                    break;
+                place(at, m_entries[parent]);
+                at = parent;
+            }
+            place(at, entry);
+        }
+
+        void sift_down(std::size_t at)
+        {
+            const auto entry = m_entries[at];
+            const std::size_t size = m_entries.size();
+            for (;;)
+            {
+                const std::size_t first_child = at * arity + 1;
+                if (first_child >= size)
+                    break;
+                const std::size_t last_child = std::min(first_child + arity, size);
+                std::size_t smallest = first_child;
+                for (std::size_t child = first_child + 1; child < last_child; ++child)
+                {
+                    if (m_entries[child].first < m_entries[smallest].first)
+                        smallest = child;
+                }
+                if (!(m_entries[smallest].first < entry.first))
+                    break;
+                place(at, m_entries[smallest]);
+                at = smallest;
+            }
+            place(at, entry);
+        }
+
+        void place(std::size_t at, const std::pair<Distance, std::size_t> &entry)
+        {
+            m_entries[at] = entry;
+            m_position[entry.second] = at;
+        }
+    };
+
+    // Result with every node unreached and the sources at distance 0, the distinct sources go to roots.
+    template <typename Distance, typename Graph>
+    shortest_path_tree<Distance> shortest_path_start(const Graph &graph, const std::vector<std::size_t> &sources, std::vector<std::size_t> &roots)
+    {
+        const std::size_t count = slot_count(graph);
+        shortest_path_tree<Distance> tree;
+        tree.distance.assign(count, shortest_path_tree<Distance>::unreachable);
+        tree.parent.assign(count, shortest_path_tree<Distance>::npos);
+        for (auto &&source : sources)
+        {
+            if (source >= count || !is_live(graph, source))
+                throw std::out_of_range("shortest paths: source is not a node of the graph");
+            tree.distance[source] = Distance{};
+            tree.parent[source] = source;
+        }
+        roots.assign(std::cbegin(sources), std::cend(sources));
+        std::sort(std::begin(roots), std::end(roots));
+        roots.erase(std::unique(std::begin(roots), std::end(roots)), std::end(roots));
+        return tree;
+    }
+
+    template <typename Distance>
+    void check_weight(const Distance &length)
+    {
+        if (length < Distance{})
+            throw std::invalid_argument("shortest paths: negative edge weight");
+    }
+}
+
+template <typename Graph, typename Weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> dijkstra(const Graph &graph, std::size_t source, const Weight &weight)
+{
+    return dijkstra(graph, std::vector<std::size_t>{source}, weight);
+}
+
+template <typename Graph, typename Weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> dijkstra(const Graph &graph, const std::vector<std::size_t> &sources, const Weight &weight)
+{
+    using Distance = path_distance_t<Graph, Weight>;
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::is_live;
+
+    std::vector<std::size_t> roots;
+    auto tree = graph_algorithms_detail::shortest_path_start<Distance>(graph, sources, roots);
+    graph_algorithms_detail::d_ary_heap<Distance> queue(tree.distance.size());
+    for (auto &&root : roots)
+        queue.push_or_decrease(root, Distance{});
+
+    while (!queue.empty())
+    {
+        const auto [distance, node] = queue.pop();
+        const auto &indices = adjacent(graph, node);
+        for (auto it = std::cbegin(indices); it != std::cend(indices); ++it)
+        {
+            const std::size_t target = *it;
+            const Distance length = graph_algorithms_detail::weight_of(it, weight);
+            graph_algorithms_detail::check_weight(length);
+            const Distance candidate = distance + length;
+            if (!(candidate < tree.distance[target]) || !is_live(graph, target))
+                continue;
+            tree.distance[target] = candidate;
+            tree.parent[target] = node;
+            queue.push_or_decrease(target, candidate);
+        }
+    }
+    return tree;
+}
+
+template <typename ExecutionPolicy, typename Graph, typename Weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> delta_stepping(ExecutionPolicy &&policy, const Graph &graph, std::size_t source,
+                                                                  path_distance_t<Graph, Weight> delta, const Weight &weight)
+{
+    return delta_stepping(std::forward<ExecutionPolicy>(policy), graph, std::vector<std::size_t>{source}, delta, weight);
+}
+
+template <typename ExecutionPolicy, typename Graph, typename Weight>
+shortest_path_tree<path_distance_t<Graph, Weight>> delta_stepping(ExecutionPolicy &&policy, const Graph &graph, const std::vector<std::size_t> &sources,
+                                                                  path_distance_t<Graph, Weight> delta, const Weight &weight)
+{
+    using Distance = path_distance_t<Graph, Weight>;
+    using graph_algorithms_detail::adjacent;
+    using graph_algorithms_detail::for_each_chunk;
+    using graph_algorithms_detail::is_live;
+    using graph_algorithms_detail::weight_of;
+    constexpr std::size_t chunk_size = 1024;
+    constexpr std::size_t npos = shortest_path_tree<Distance>::npos;
+
+    std::vector<std::size_t> roots;
+    auto tree = graph_algorithms_detail::shortest_path_start<Distance>(graph, sources, roots);
+    const std::size_t count = tree.distance.size();
+
+    if (!(Distance{} < delta))
+    {
+        // the average weight, also checks for negative weights up front
+        Distance total{};
+        std::size_t edges = 0;
+        for (std::size_t node = 0; node < count; ++node)
+        {
+            if (!is_live(graph, node))
+                continue;
+            const auto &indices = adjacent(graph, node);
+            for (auto it = std::cbegin(indices); it != std::cend(indices); ++it, ++edges)
+            {
+                const Distance length = weight_of(it, weight);
+                graph_algorithms_detail::check_weight(length);
+                total += length;
+            }
+        }
+        delta = edges != 0 ? static_cast<Distance>(total / static_cast<Distance>(edges)) : Distance{};
+        if (!(Distance{} < delta))
+            delta = Distance{1};
+    }
+
+    // buckets[i] holds the nodes with a distance in [i * delta, (i + 1) * delta). A node is only in
+    // the bucket bucket_of names, entries left behind when its distance drops are skipped.
+    std::vector<std::vector<std::size_t>> buckets;
+    std::vector<std::size_t> bucket_of(count, npos);
+    const auto bucket_index = [&](const Distance &distance)
+    { return static_cast<std::size_t>(distance / delta); };
+    const auto enqueue = [&](std::size_t node)
+    {
+        const std::size_t index = bucket_index(tree.distance[node]);
+        if (bucket_of[node] == index)
+            return;
+        if (index >= buckets.size())
+            buckets.resize(index + 1);
+        buckets[index].push_back(node);
+        bucket_of[node] = index;
+    };
+    for (auto &&root : roots)
+        enqueue(root);
+
+    struct request
+    {
+        std::size_t m_target;
+        std::size_t m_parent;
+        Distance m_distance;
+    };
+    std::vector<std::vector<request>> requests;
+    // set by the tasks instead of throwing, an exception must not leave a parallel algorithm
+    std::atomic<bool> negative_weight{false};
+    // Relaxes the light or the heavy edges of nodes: requests are made per chunk in parallel, reading
+    // the distances only, then applied in order, which is the only place distances change.
+    const auto relax = [&](const std::vector<std::size_t> &nodes, bool light)
+    {
+        requests.resize(std::max(requests.size(), (nodes.size() + chunk_size - 1) / chunk_size));
+        for_each_chunk(policy, nodes.size(), chunk_size, [&](std::size_t first, std::size_t last)
+                       {
+            auto &made = requests[first / chunk_size];
+            made.clear();
+            for (std::size_t at = first; at < last; ++at)
+            {
+                const std::size_t node = nodes[at];
+                const auto &indices = adjacent(graph, node);
+                for (auto it = std::cbegin(indices); it != std::cend(indices); ++it)
+                {
+                    const std::size_t target = *it;
+                    const Distance length = weight_of(it, weight);
+                    if (length < Distance{})
+                        negative_weight.store(true, std::memory_order_relaxed);
+                    if ((length <= delta) != light)
+                        continue;
+                    const Distance candidate = tree.distance[node] + length;
+                    if (candidate < tree.distance[target] && is_live(graph, target))
+                        made.push_back({target, node, candidate});
+                }
+            } });
+        if (negative_weight.load())
+            throw std::invalid_argument("shortest paths: negative edge weight");
+        for (auto &&made : requests)
+        {
+            for (auto &&relaxation : made)
+            {
+                if (!(relaxation.m_distance < tree.distance[relaxation.m_target]))
+                    continue;
+                tree.distance[relaxation.m_target] = relaxation.m_distance;
+                tree.parent[relaxation.m_target] = relaxation.m_parent;
+                enqueue(relaxation.m_target);
+            }
+            made.clear();
+        }
+    };
+
+    std::vector<std::size_t> current;
+    std::vector<std::size_t> settled;
+    for (std::size_t index = 0; index < buckets.size(); ++index)
+    {
+        settled.clear();
+        // light edges can put nodes back into this bucket, repeat until it stays empty
+        while (!buckets[index].empty())
+        {
+            current.clear();
+            current.swap(buckets[index]);
+            current.erase(std::remove_if(std::begin(current), std::end(current), [&](std::size_t node)
+                                         { return bucket_of[node] != index; }),
+                          std::end(current));
+            for (auto &&node : current)
+                bucket_of[node] = npos;
+            settled.insert(std::end(settled), std::cbegin(current), std::cend(current));
+            relax(current, true);
+        }
+        // a node can be settled several times while the bucket is emptied, its heavy edges are relaxed once
+        std::sort(std::begin(settled), std::end(settled));
+        settled.erase(std::unique(std::begin(settled), std::end(settled)), std::end(settled));
+        relax(settled, false);
+    }
+    return tree;
+}
+#endif
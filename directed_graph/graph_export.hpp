@@ -0,0 +1,274 @@
+#ifndef GRAPH_EXPORT_HPP
+#define GRAPH_EXPORT_HPP
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "execution_dispatch.hpp"
+
+// Streaming export of a directed_graph to text formats. Nodes are walked by index and their
+// adjacency indices read in place, numbers are formatted with std::to_chars and output goes
+// through one large buffer, so exporting does not copy the graph and the sink sees few, large writes.
+// A sink is either a std::ostream or any callable taking a std::string_view.
+
+enum class export_format
+{
+    dot,           // Graphviz digraph, nodes without outgoing edges are listed on their own
+    edge_list,     // one "source target" line per edge
+    matrix_market  // coordinate pattern matrix with 1-based node indices, e.g. for SciPy or SuiteSparse
+};
+
+struct export_options
+{
+    export_format format = export_format::dot;
+    std::string graph_name = "G";
+    // bytes buffered before the sink is written to
+    std::size_t buffer_size = 1 << 16;
+    // nodes formatted per task by the parallel overload
+    std::size_t chunk_size = 4096;
+};
+
+// Writes graph to sink in the format given by options.
+template <typename DirectedGraph, typename Sink>
+void export_graph(const DirectedGraph &graph, Sink &&sink, const export_options &options = {});
+// Same, but formats chunks of nodes as separate tasks under the given execution policy
+// and writes the chunks in node order.
+template <typename ExecutionPolicy, typename DirectedGraph, typename Sink>
+    requires(!std::is_same_v<std::remove_cvref_t<Sink>, export_options>)
+void export_graph(ExecutionPolicy &&policy, const DirectedGraph &graph, Sink &&sink, const export_options &options = {});
+
+namespace graph_export_detail
+{
+    template <typename Sink>
+    void write(Sink &sink, std::string_view text)
+    {
+        if constexpr (std::is_base_of_v<std::ostream, std::remove_cvref_t<Sink>>)
+            sink.write(text.data(), static_cast<std::streamsize>(text.size()));
+        else
+            sink(text);
+    }
+
+    template <typename T>
+    inline constexpr bool is_number_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+
+    template <typename T>
+    void append_value(std::string &out, const T &value)
+    {
+        if constexpr (is_number_v<T>)
+        {
+            char digits[64];
+            const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+            out.append(digits, result.ptr);
+        }
+        else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+        {
+            out.append(std::string_view(value));
+        }
+        else
+        {
+            // slow path for types that only know operator<<
+            std::ostringstream stream;
+            stream << value;
+            out.append(stream.str());
+        }
+    }
+
+    // DOT only accepts plain numerals unquoted, everything else becomes a quoted ID
+    template <typename T>
+    void append_dot_id(std::string &out, const T &value)
+    {
+        if constexpr (std::is_integral_v<T> && is_number_v<T>)
+        {
+            append_value(out, value);
+        }
+        else
+        {
+            std::string text;
+            append_value(text, value);
+            out.push_back('"');
+            for (auto &&c : text)
+            {
+                if (c == '"' || c == '\\')
+                    out.push_back('\\');
+                out.push_back(c);
+            }
+            out.push_back('"');
+        }
+    }
+
+    // Formats the nodes [first, last) of graph into out. remap holds the 1-based Matrix Market
+    // index of every node and is only used for that format.
+    template <typename DirectedGraph>
+    void format_nodes(const DirectedGraph &graph, std::size_t first, std::size_t last, export_format format,
+                      const std::vector<std::size_t> &remap, std::string &out)
+    {
+        const auto &nodes = graph.m_nodes;
+        for (std::size_t index = first; index < last; ++index)
+        {
+            if (graph.is_erased(index))
+                continue;
+            const auto &adjacent = nodes[index].get_adjacent_node_indices();
+            switch (format)
+            {
+            case export_format::dot:
+            {
+                bool has_edges = false;
+                for (auto &&target : adjacent)
+                {
+                    if (graph.is_erased(target))
+                        continue;
+                    out.append("    ");
+                    append_dot_id(out, nodes[index].get());
+                    out.append(" -> ");
+                    append_dot_id(out, nodes[target].get());
+                    out.append(";\n");
+                    has_edges = true;
+                }
+                if (!has_edges)
+                {
+                    out.append("    ");
+                    append_dot_id(out, nodes[index].get());
+                    out.append(";\n");
+                }
+                break;
+            }
+            case export_format::edge_list:
+                for (auto &&target : adjacent)
+                {
+                    if (graph.is_erased(target))
+                        continue;
+                    append_value(out, nodes[index].get());
+                    out.push_back(' ');
+                    append_value(out, nodes[target].get());
+                    out.push_back('\n');
+                }
+                break;
+            case export_format::matrix_market:
+                for (auto &&target : adjacent)
+                {
+                    if (graph.is_erased(target))
+                        continue;
+                    append_value(out, remap[index]);
+                    out.push_back(' ');
+                    append_value(out, remap[target]);
+                    out.push_back('\n');
+                }
+                break;
+            }
+        }
+    }
+
+    // Everything before the per-node lines. Matrix Market needs the live node and edge counts,
+    // and 1-based indices that skip tombstoned nodes, which are computed into remap.
+    template <typename DirectedGraph>
+    void format_header(const DirectedGraph &graph, const export_options &options, std::vector<std::size_t> &remap, std::string &out)
+    {
+        switch (options.format)
+        {
+        case export_format::dot:
+            out.append("digraph ");
+            append_dot_id(out, options.graph_name);
+            out.append(" {\n");
+            break;
+        case export_format::edge_list:
+            break;
+        case export_format::matrix_market:
+        {
+            const auto &nodes = graph.m_nodes;
+            remap.resize(nodes.size());
+            std::size_t live_count = 0;
+            for (std::size_t index = 0; index < nodes.size(); ++index)
+                remap[index] = graph.is_erased(index) ? 0 : ++live_count;
+            std::size_t edge_count = 0;
+            for (std::size_t index = 0; index < nodes.size(); ++index)
+            {
+                if (remap[index] == 0)
+                    continue;
+                for (auto &&target : nodes[index].get_adjacent_node_indices())
+                    edge_count += remap[target] != 0;
+            }
+            out.append("%%MatrixMarket matrix coordinate pattern general\n");
+            append_value(out, live_count);
+            out.push_back(' ');
+            append_value(out, live_count);
+            out.push_back(' ');
+            append_value(out, edge_count);
+            out.push_back('\n');
+            break;
+        }
+        }
+    }
+
+    inline void format_footer(const export_options &options, std::string &out)
+    {
+        if (options.format == export_format::dot)
+            out.append("}\n");
+    }
+}
+
+template <typename DirectedGraph, typename Sink>
+void export_graph(const DirectedGraph &graph, Sink &&sink, const export_options &options)
+{
+    std::string buffer;
+    buffer.reserve(options.buffer_size);
+    std::vector<std::size_t> remap;
+    graph_export_detail::format_header(graph, options, remap, buffer);
+
+    // one node at a time, flushing whenever the buffer is full; a single node may overshoot it
+    const std::size_t node_count = graph.m_nodes.size();
+    for (std::size_t index = 0; index < node_count; ++index)
+    {
+        graph_export_detail::format_nodes(graph, index, index + 1, options.format, remap, buffer);
+        if (buffer.size() >= options.buffer_size)
+        {
+            graph_export_detail::write(sink, buffer);
+            buffer.clear();
+        }
+    }
+
+    graph_export_detail::format_footer(options, buffer);
+    graph_export_detail::write(sink, buffer);
+}
+
+template <typename ExecutionPolicy, typename DirectedGraph, typename Sink>
+    requires(!std::is_same_v<std::remove_cvref_t<Sink>, export_options>)
+void export_graph(ExecutionPolicy &&policy, const DirectedGraph &graph, Sink &&sink, const export_options &options)
+{
+    std::string header;
+    std::vector<std::size_t> remap;
+    graph_export_detail::format_header(graph, options, remap, header);
+    graph_export_detail::write(sink, header);
+
+    const std::size_t node_count = graph.m_nodes.size();
+    const std::size_t chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+    const std::size_t chunk_count = (node_count + chunk_size - 1) / chunk_size;
+    // Chunks are formatted a batch at a time so at most a batch worth of text is held in memory.
+    constexpr std::size_t batch_size = 64;
+    std::vector<std::string> chunks(std::min(chunk_count, batch_size));
+    std::vector<std::size_t> chunk_ids(chunks.size());
+
+    for (std::size_t batch_first = 0; batch_first < chunk_count; batch_first += chunks.size())
+    {
+        const std::size_t batch_count = std::min(chunks.size(), chunk_count - batch_first);
+        std::iota(std::begin(chunk_ids), std::begin(chunk_ids) + batch_count, std::size_t{0});
+        execution_dispatch::for_each(policy, std::begin(chunk_ids), std::begin(chunk_ids) + batch_count, [&](std::size_t chunk)
+                                     {
+            const std::size_t first = (batch_first + chunk) * chunk_size;
+            chunks[chunk].clear();
+            graph_export_detail::format_nodes(graph, first, std::min(first + chunk_size, node_count), options.format, remap, chunks[chunk]); });
+        for (std::size_t chunk = 0; chunk < batch_count; ++chunk)
+            graph_export_detail::write(sink, chunks[chunk]);
+    }
+
+    std::string footer;
+    graph_export_detail::format_footer(options, footer);
+    graph_export_detail::write(sink, footer);
+}
+#endif
@@ -0,0 +1,794 @@
+#ifndef GRAPH_FILE_HPP
+#define GRAPH_FILE_HPP
+#include <algorithm>
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csr_graph.hpp"
+#include "const_adjacent_nodes_iterator.hpp"
+#include "const_indexed_node_iterator.hpp"
+
+// Binary on-disk graph format, designed to be mmap'ed and queried in place.
+//
+// The file is a graph_file_header followed by sections, each starting at a multiple of
+// graph_file_alignment, all integers 64-bit in the byte order of the writer:
+//   offsets   node_count + 1 entries, the edges of node i are targets[offsets[i] .. offsets[i + 1])
+//   targets   edge_count sorted node indices (CSR, same layout as csr_graph)
+//   values    node_count values of a trivially copyable T, or for strings
+//             node_count + 1 offsets into the string data section
+//   strings   the concatenated string values (string graphs only)
+//   order     node indices sorted by value, for O(log V) lookups (omitted if T has no operator<)
+// Node indices are those of the graph after compaction.
+
+inline constexpr char graph_file_magic[8] = {'D', 'G', 'R', 'A', 'P', 'H', '\0', '\0'};
+inline constexpr std::uint32_t graph_file_version = 1;
+inline constexpr std::uint32_t graph_file_byte_order = 0x01020304;
+inline constexpr std::uint64_t graph_file_alignment = 64;
+
+enum class graph_file_value_kind : std::uint32_t
+{
+    trivially_copyable = 0,
+    string = 1
+};
+
+struct graph_file_header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    graph_file_value_kind value_kind;
+    std::uint32_t reserved;
+    std::uint64_t value_size; // sizeof(T) for trivially copyable values, 0 for strings
+    std::uint64_t node_count;
+    std::uint64_t edge_count;
+    std::uint64_t offsets_offset;
+    std::uint64_t targets_offset;
+    std::uint64_t values_offset;
+    std::uint64_t strings_offset;
+    std::uint64_t strings_size;
+    std::uint64_t order_offset; // 0 if the file has no order section
+    std::uint64_t file_size;
+};
+static_assert(std::is_trivially_copyable_v<graph_file_header> && sizeof(graph_file_header) == 104);
+// adjacency indices are handed out as csr_adjacency_list, i.e. as std::size_t pointers into the mapping
+static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "the graph file format needs a 64-bit std::size_t");
+
+// Values convertible to std::string_view are stored as strings, other values must be trivially copyable.
+template <typename T>
+inline constexpr bool is_graph_file_string_v = std::is_convertible_v<const T &, std::string_view>;
+
+template <typename T>
+inline constexpr bool is_graph_file_value_v = is_graph_file_string_v<T> || std::is_trivially_copyable_v<T>;
+
+// Writes the graph to out in the format above, streaming node by node without copying the graph.
+// The format has no edge property section, so graphs with edge properties are rejected.
+template <typename DirectedGraph>
+void write_graph_file(const DirectedGraph &graph, std::ostream &out);
+// Same, to the file at path. Throws std::system_error if the file cannot be written.
+template <typename DirectedGraph>
+void write_graph_file(const DirectedGraph &graph, const std::string &path);
+
+// How much of a graph file mapped_graph checks when it is opened.
+// sections: the header and the section bounds, O(1); the section contents are trusted.
+// full: also every offset, target and order entry, O(V + E), so that a corrupt file is rejected
+// instead of turning into out-of-bounds reads later. Use sections only for files known to be intact.
+enum class graph_file_check
+{
+    sections,
+    full
+};
+
+// Read-only graph backed by a memory-mapped graph file; nothing is deserialized, every query
+// reads the mapping directly. For string graphs, values are handed out as std::string_view.
+// Offers the same const query surface as csr_graph.
+template <typename T>
+class mapped_graph
+{
+    static_assert(is_graph_file_value_v<T>, "mapped_graph needs trivially copyable or string values");
+
+public:
+    static constexpr bool stores_strings = is_graph_file_string_v<T>;
+
+    // public type aliases
+    using value_type = std::conditional_t<stores_strings, std::string_view, T>;
+    using reference = std::conditional_t<stores_strings, std::string_view, const value_type &>;
+    using const_reference = reference;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using adjacency_list_type = csr_adjacency_list;
+
+    // public iterator-related type aliases, the graph is read-only
+    using const_iterator = const_indexed_node_iterator<mapped_graph>;
+    using iterator = const_iterator;
+    using const_iterator_adjacent_nodes = const_adjacent_nodes_iterator<mapped_graph>;
+    using iterator_adjacent_nodes = const_iterator_adjacent_nodes;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+    using const_reverse_iterator_adjacent_nodes = std::reverse_iterator<const_iterator_adjacent_nodes>;
+    using reverse_iterator_adjacent_nodes = const_reverse_iterator_adjacent_nodes;
+    using adjacent_nodes_view = std::ranges::subrange<const_iterator_adjacent_nodes>;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    // Maps the file at path. Throws std::system_error if it cannot be opened or mapped
+    // and std::runtime_error if it is not a graph file holding values of type T or fails the check.
+    explicit mapped_graph(const std::string &path, graph_file_check check = graph_file_check::full);
+    mapped_graph(const mapped_graph &) = delete;
+    mapped_graph &operator=(const mapped_graph &) = delete;
+    mapped_graph(mapped_graph &&other) noexcept;
+    mapped_graph &operator=(mapped_graph &&rhs) noexcept;
+    ~mapped_graph();
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_reverse_iterator crbegin() const noexcept;
+    const_reverse_iterator crend() const noexcept;
+
+    // return iterator to the list of adjacent nodes for the given node
+    // return a default constructed iterator as the end iterator if the value is not found
+    const_iterator_adjacent_nodes begin(const value_type &node_value) const noexcept;
+    const_iterator_adjacent_nodes end(const value_type &node_value) const noexcept;
+    const_iterator_adjacent_nodes cbegin(const value_type &node_value) const noexcept;
+    const_iterator_adjacent_nodes cend(const value_type &node_value) const noexcept;
+
+    const_reverse_iterator_adjacent_nodes rbegin(const value_type &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes rend(const value_type &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes crbegin(const value_type &node_value) const noexcept;
+    const_reverse_iterator_adjacent_nodes crend(const value_type &node_value) const noexcept;
+
+    const_reference operator[](size_type index) const;
+    const_reference at(size_type index) const;
+
+    // Index of the node with the given value, npos if there is none.
+    size_type find_index(const value_type &node_value) const noexcept;
+
+    // Sorted adjacency indices of the node at the given index.
+    adjacency_list_type get_adjacent_node_indices(size_type index) const noexcept;
+
+    // Same semantics as directed_graph::operator==
+    bool operator==(const mapped_graph &rhs) const;
+    bool operator!=(const mapped_graph &rhs) const;
+
+    // A moved-from mapped_graph is empty.
+    void swap(mapped_graph &other_graph) noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+    bool empty() const noexcept;
+    size_type edge_count() const noexcept;
+
+    // Returns a set with the nodes adjacent to the given node.
+    std::set<value_type> get_adjacent_node_values(const value_type &node_value) const;
+    // Same semantics as directed_graph::neighbors
+    adjacent_nodes_view neighbors(const value_type &node_value) const noexcept;
+
+private:
+    const unsigned char *m_data = nullptr;
+    std::size_t m_mappedSize = 0;
+    const graph_file_header *m_header = nullptr;
+    const std::size_t *m_offsets = nullptr;
+    const std::size_t *m_targets = nullptr;
+    const void *m_values = nullptr;
+    const char *m_strings = nullptr;
+    const std::size_t *m_order = nullptr;
+
+    void validate() const;
+    // The graph_file_check::full part of the validation, needs the section pointers.
+    void validate_contents() const;
+    bool value_less(size_type index, const value_type &value) const noexcept;
+};
+
+namespace graph_file_detail
+{
+    inline std::uint64_t align(std::uint64_t position)
+    {
+        return (position + graph_file_alignment - 1) / graph_file_alignment * graph_file_alignment;
+    }
+
+    // Buffers the many small writes of the node-by-node streaming into large ones.
+    class buffered_writer
+    {
+    public:
+        explicit buffered_writer(std::ostream &out) : m_out(out) { m_buffer.reserve(buffer_size); }
+        ~buffered_writer() { flush(); }
+
+        void write(const void *data, std::size_t size)
+        {
+            if (m_buffer.size() + size > buffer_size)
+                flush();
+            if (size > buffer_size)
+            {
+                m_out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+            }
+            else
+            {
+                const auto bytes = static_cast<const char *>(data);
+                m_buffer.insert(std::end(m_buffer), bytes, bytes + size);
+            }
+            m_position += size;
+        }
+
+        void write_u64(std::uint64_t value) { write(&value, sizeof(value)); }
+
+        void pad_to(std::uint64_t position)
+        {
+            static constexpr char zeros[graph_file_alignment] = {};
+            while (m_position < position)
+                write(zeros, std::min<std::uint64_t>(position - m_position, sizeof(zeros)));
+        }
+
+        void flush()
+        {
+            m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+
+    private:
+        static constexpr std::size_t buffer_size = 1 << 16;
+        std::ostream &m_out;
+        std::vector<char> m_buffer;
+        std::uint64_t m_position = 0;
+    };
+}
+
+template <typename DirectedGraph>
+void write_graph_file(const DirectedGraph &graph, std::ostream &out)
+{
+    using T = typename DirectedGraph::value_type;
+    static_assert(is_graph_file_value_v<T>, "graph files hold trivially copyable or string values");
+    static_assert(!DirectedGraph::has_edge_properties, "graph files hold no edge properties");
+    constexpr bool is_string = is_graph_file_string_v<T>;
+    constexpr bool is_ordered = is_string || std::totally_ordered<T>;
+
+    const auto &nodes = graph.m_nodes;
+    // Tombstoned nodes are left out and the rest renumbered the way compact() would do it.
+    constexpr std::size_t erased = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> remap(nodes.size());
+    std::size_t live_count = 0;
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+        remap[index] = graph.is_erased(index) ? erased : live_count++;
+
+    std::uint64_t edge_count = 0;
+    std::uint64_t strings_size = 0;
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        for (auto &&target : nodes[index].get_adjacent_node_indices())
+            edge_count += remap[target] != erased;
+        if constexpr (is_string)
+            strings_size += std::string_view(nodes[index].get()).size();
+    }
+
+    graph_file_header header{};
+    std::memcpy(header.magic, graph_file_magic, sizeof(header.magic));
+    header.version = graph_file_version;
+    header.byte_order = graph_file_byte_order;
+    header.value_kind = is_string ? graph_file_value_kind::string : graph_file_value_kind::trivially_copyable;
+    header.value_size = is_string ? 0 : sizeof(T);
+    header.node_count = live_count;
+    header.edge_count = edge_count;
+
+    using graph_file_detail::align;
+    header.offsets_offset = align(sizeof(graph_file_header));
+    header.targets_offset = align(header.offsets_offset + (live_count + 1) * sizeof(std::uint64_t));
+    header.values_offset = align(header.targets_offset + edge_count * sizeof(std::uint64_t));
+    std::uint64_t position = header.values_offset + (is_string ? (live_count + 1) * sizeof(std::uint64_t) : live_count * header.value_size);
+    if constexpr (is_string)
+    {
+        header.strings_offset = align(position);
+        header.strings_size = strings_size;
+        position = header.strings_offset + strings_size;
+    }
+    if constexpr (is_ordered)
+    {
+        header.order_offset = align(position);
+        position = header.order_offset + live_count * sizeof(std::uint64_t);
+    }
+    header.file_size = align(position);
+
+    graph_file_detail::buffered_writer writer(out);
+    writer.write(&header, sizeof(header));
+
+    writer.pad_to(header.offsets_offset);
+    std::uint64_t offset = 0;
+    writer.write_u64(offset);
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        for (auto &&target : nodes[index].get_adjacent_node_indices())
+            offset += remap[target] != erased;
+        writer.write_u64(offset);
+    }
+
+    writer.pad_to(header.targets_offset);
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        // adjacency lists are sorted and remap is monotonic, so every row stays sorted
+        for (auto &&target : nodes[index].get_adjacent_node_indices())
+        {
+            if (remap[target] != erased)
+                writer.write_u64(remap[target]);
+        }
+    }
+
+    writer.pad_to(header.values_offset);
+    if constexpr (is_string)
+    {
+        std::uint64_t string_offset = 0;
+        writer.write_u64(string_offset);
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+        {
+            if (remap[index] == erased)
+                continue;
+            string_offset += std::string_view(nodes[index].get()).size();
+            writer.write_u64(string_offset);
+        }
+        writer.pad_to(header.strings_offset);
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+        {
+            if (remap[index] == erased)
+                continue;
+            const std::string_view value(nodes[index].get());
+            writer.write(value.data(), value.size());
+        }
+    }
+    else
+    {
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+        {
+            if (remap[index] != erased)
+                writer.write(&nodes[index].get(), sizeof(T));
+        }
+    }
+
+    if constexpr (is_ordered)
+    {
+        writer.pad_to(header.order_offset);
+        std::vector<std::size_t> order;
+        order.reserve(live_count);
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+        {
+            if (remap[index] != erased)
+                order.push_back(index);
+        }
+        std::sort(std::begin(order), std::end(order), [&nodes](std::size_t lhs, std::size_t rhs)
+                  {
+            if constexpr (is_string)
+                return std::string_view(nodes[lhs].get()) < std::string_view(nodes[rhs].get());
+            else
+                return nodes[lhs].get() < nodes[rhs].get(); });
+        for (auto &&index : order)
+            writer.write_u64(remap[index]);
+    }
+    writer.pad_to(header.file_size);
+}
+
+template <typename DirectedGraph>
+void write_graph_file(const DirectedGraph &graph, const std::string &path)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+    write_graph_file(graph, out);
+    out.flush();
+    if (!out)
+        throw std::system_error(errno, std::generic_category(), "cannot write " + path);
+}
+
+template <typename T>
+mapped_graph<T>::mapped_graph(const std::string &path, graph_file_check check)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "cannot stat " + path);
+    }
+    m_mappedSize = static_cast<std::size_t>(status.st_size);
+    if (m_mappedSize < sizeof(graph_file_header))
+    {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a graph file");
+    }
+
+    void *data = ::mmap(nullptr, m_mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd); // the mapping keeps the file alive
+    if (data == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), "cannot map " + path);
+    m_data = static_cast<const unsigned char *>(data);
+
+    m_header = reinterpret_cast<const graph_file_header *>(m_data);
+    try
+    {
+        validate();
+        m_offsets = reinterpret_cast<const std::size_t *>(m_data + m_header->offsets_offset);
+        m_targets = reinterpret_cast<const std::size_t *>(m_data + m_header->targets_offset);
+        m_values = m_data + m_header->values_offset;
+        if (m_header->value_kind == graph_file_value_kind::string)
+            m_strings = reinterpret_cast<const char *>(m_data + m_header->strings_offset);
+        if (m_header->order_offset != 0)
+            m_order = reinterpret_cast<const std::size_t *>(m_data + m_header->order_offset);
+        if (check == graph_file_check::full)
+            validate_contents();
+    }
+    catch (...)
+    {
+        ::munmap(const_cast<unsigned char *>(m_data), m_mappedSize);
+        throw;
+    }
+}
+
+template <typename T>
+void mapped_graph<T>::validate() const
+{
+    const graph_file_header &header = *m_header;
+    if (std::memcmp(header.magic, graph_file_magic, sizeof(header.magic)) != 0)
+        throw std::runtime_error("not a graph file");
+    if (header.version != graph_file_version)
+        throw std::runtime_error("unsupported graph file version " + std::to_string(header.version));
+    if (header.byte_order != graph_file_byte_order)
+        throw std::runtime_error("graph file was written with a different byte order");
+
+    const auto expected_kind = stores_strings ? graph_file_value_kind::string : graph_file_value_kind::trivially_copyable;
+    const std::uint64_t expected_size = stores_strings ? 0 : sizeof(T);
+    if (header.value_kind != expected_kind || header.value_size != expected_size)
+        throw std::runtime_error("graph file holds a different value type");
+
+    // the section bounds, the contents are checked by validate_contents(); neither the offset nor
+    // count * size is ever computed in a way that can wrap around
+    const auto fits = [this](std::uint64_t offset, std::uint64_t count, std::uint64_t size)
+    {
+        return offset % graph_file_alignment == 0 && offset <= m_mappedSize && count <= (m_mappedSize - offset) / size;
+    };
+    // node_count + 1 offsets must fit behind offsets_offset, so node_count + 1 below cannot wrap
+    if (header.offsets_offset > m_mappedSize || header.node_count >= (m_mappedSize - header.offsets_offset) / sizeof(std::uint64_t))
+        throw std::runtime_error("truncated or corrupt graph file");
+    const std::uint64_t values_count = stores_strings ? header.node_count + 1 : header.node_count;
+    if (header.file_size > m_mappedSize || !fits(header.offsets_offset, header.node_count + 1, sizeof(std::uint64_t)) ||
+        !fits(header.targets_offset, header.edge_count, sizeof(std::uint64_t)) ||
+        !fits(header.values_offset, values_count, stores_strings ? sizeof(std::uint64_t) : sizeof(T)) ||
+        (stores_strings && !fits(header.strings_offset, header.strings_size, 1)) ||
+        (header.order_offset != 0 && !fits(header.order_offset, header.node_count, sizeof(std::uint64_t))))
+        throw std::runtime_error("truncated or corrupt graph file");
+}
+
+template <typename T>
+void mapped_graph<T>::validate_contents() const
+{
+    const std::uint64_t node_count = m_header->node_count;
+    // offsets start at 0, never decrease and end at edge_count; each row is sorted and in range.
+    // A row is only read once its end is known to lie within the targets.
+    if (m_offsets[0] != 0 || m_offsets[node_count] != m_header->edge_count)
+        throw std::runtime_error("corrupt graph file: bad edge offsets");
+    for (std::uint64_t node = 0; node < node_count; ++node)
+    {
+        if (m_offsets[node + 1] < m_offsets[node] || m_offsets[node + 1] > m_header->edge_count)
+            throw std::runtime_error("corrupt graph file: bad edge offsets");
+        for (std::uint64_t edge = m_offsets[node]; edge < m_offsets[node + 1]; ++edge)
+        {
+            if (m_targets[edge] >= node_count || (edge != m_offsets[node] && m_targets[edge] <= m_targets[edge - 1]))
+                throw std::runtime_error("corrupt graph file: bad edge target");
+        }
+    }
+
+    if constexpr (stores_strings)
+    {
+        const auto string_offsets = static_cast<const std::size_t *>(m_values);
+        if (string_offsets[0] != 0)
+            throw std::runtime_error("corrupt graph file: bad string offsets");
+        for (std::uint64_t node = 0; node < node_count; ++node)
+        {
+            if (string_offsets[node + 1] < string_offsets[node] || string_offsets[node + 1] > m_header->strings_size)
+                throw std::runtime_error("corrupt graph file: bad string offsets");
+        }
+    }
+
+    if (m_order != nullptr)
+    {
+        for (std::uint64_t position = 0; position < node_count; ++position)
+        {
+            if (m_order[position] >= node_count)
+                throw std::runtime_error("corrupt graph file: bad order entry");
+        }
+    }
+}
+
+template <typename T>
+mapped_graph<T>::mapped_graph(mapped_graph &&other) noexcept
+{
+    swap(other);
+}
+
+template <typename T>
+mapped_graph<T> &mapped_graph<T>::operator=(mapped_graph &&rhs) noexcept
+{
+    mapped_graph tmp(std::move(rhs));
+    swap(tmp);
+    return *this;
+}
+
+template <typename T>
+mapped_graph<T>::~mapped_graph()
+{
+    if (m_data != nullptr)
+        ::munmap(const_cast<unsigned char *>(m_data), m_mappedSize);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator mapped_graph<T>::begin() const noexcept
+{
+    return const_iterator(0, this);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator mapped_graph<T>::end() const noexcept
+{
+    return const_iterator(size(), this);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator mapped_graph<T>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator mapped_graph<T>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator mapped_graph<T>::rbegin() const noexcept
+{
+    return const_reverse_iterator(end());
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator mapped_graph<T>::rend() const noexcept
+{
+    return const_reverse_iterator(begin());
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator mapped_graph<T>::crbegin() const noexcept
+{
+    return rbegin();
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator mapped_graph<T>::crend() const noexcept
+{
+    return rend();
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator_adjacent_nodes mapped_graph<T>::begin(const value_type &node_value) const noexcept
+{
+    const size_type index = find_index(node_value);
+    if (index == npos) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    return const_iterator_adjacent_nodes(std::begin(get_adjacent_node_indices(index)), this);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator_adjacent_nodes mapped_graph<T>::end(const value_type &node_value) const noexcept
+{
+    const size_type index = find_index(node_value);
+    if (index == npos) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    return const_iterator_adjacent_nodes(std::end(get_adjacent_node_indices(index)), this);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator_adjacent_nodes mapped_graph<T>::cbegin(const value_type &node_value) const noexcept
+{
+    return begin(node_value);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_iterator_adjacent_nodes mapped_graph<T>::cend(const value_type &node_value) const noexcept
+{
+    return end(node_value);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator_adjacent_nodes mapped_graph<T>::rbegin(const value_type &node_value) const noexcept
+{
+    return const_reverse_iterator_adjacent_nodes(end(node_value));
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator_adjacent_nodes mapped_graph<T>::rend(const value_type &node_value) const noexcept
+{
+    return const_reverse_iterator_adjacent_nodes(begin(node_value));
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator_adjacent_nodes mapped_graph<T>::crbegin(const value_type &node_value) const noexcept
+{
+    return rbegin(node_value);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reverse_iterator_adjacent_nodes mapped_graph<T>::crend(const value_type &node_value) const noexcept
+{
+    return rend(node_value);
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reference mapped_graph<T>::operator[](size_type index) const
+{
+    if constexpr (stores_strings)
+    {
+        const auto string_offsets = static_cast<const std::size_t *>(m_values);
+        return std::string_view(m_strings + string_offsets[index], string_offsets[index + 1] - string_offsets[index]);
+    }
+    else
+    {
+        return static_cast<const T *>(m_values)[index];
+    }
+}
+
+template <typename T>
+typename mapped_graph<T>::const_reference mapped_graph<T>::at(size_type index) const
+{
+    if (index >= size())
+        throw std::out_of_range("mapped_graph::at");
+    return (*this)[index];
+}
+
+template <typename T>
+bool mapped_graph<T>::value_less(size_type index, const value_type &value) const noexcept
+{
+    return (*this)[index] < value;
+}
+
+template <typename T>
+typename mapped_graph<T>::size_type mapped_graph<T>::find_index(const value_type &node_value) const noexcept
+{
+    if (m_order != nullptr)
+    {
+        const auto last = m_order + size();
+        const auto found = std::lower_bound(m_order, last, node_value, [this](std::size_t index, const value_type &value)
+                                            { return value_less(index, value); });
+        if (found != last && (*this)[*found] == node_value)
+            return *found;
+        return npos;
+    }
+
+    for (size_type index = 0; index < size(); ++index)
+    {
+        if ((*this)[index] == node_value)
+            return index;
+    }
+    return npos;
+}
+
+template <typename T>
+typename mapped_graph<T>::adjacency_list_type mapped_graph<T>::get_adjacent_node_indices(size_type index) const noexcept
+{
+    return adjacency_list_type(m_targets + m_offsets[index], m_targets + m_offsets[index + 1]);
+}
+
+template <typename T>
+bool mapped_graph<T>::operator==(const mapped_graph &rhs) const
+{
+    if (size() != rhs.size() || edge_count() != rhs.edge_count())
+        return false;
+
+    // indices of the lhs nodes in rhs, looked up once
+    std::vector<size_type> remap(size());
+    for (size_type index = 0; index < size(); ++index)
+    {
+        remap[index] = rhs.find_index((*this)[index]);
+        if (remap[index] == npos)
+            return false;
+    }
+    for (size_type index = 0; index < size(); ++index)
+    {
+        const auto lhs_indices = get_adjacent_node_indices(index);
+        const auto rhs_indices = rhs.get_adjacent_node_indices(remap[index]);
+        if (lhs_indices.size() != rhs_indices.size())
+            return false;
+        // rhs rows are sorted, so every remapped lhs target can be binary searched
+        for (auto &&target : lhs_indices)
+        {
+            if (!std::binary_search(std::begin(rhs_indices), std::end(rhs_indices), remap[target]))
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool mapped_graph<T>::operator!=(const mapped_graph &rhs) const
+{
+    return !(*this == rhs);
+}
+
+template <typename T>
+void mapped_graph<T>::swap(mapped_graph &other) noexcept
+{
+    using std::swap;
+
+    swap(m_data, other.m_data);
+    swap(m_mappedSize, other.m_mappedSize);
+    swap(m_header, other.m_header);
+    swap(m_offsets, other.m_offsets);
+    swap(m_targets, other.m_targets);
+    swap(m_values, other.m_values);
+    swap(m_strings, other.m_strings);
+    swap(m_order, other.m_order);
+}
+
+template <typename T>
+typename mapped_graph<T>::size_type mapped_graph<T>::size() const noexcept
+{
+    return m_header != nullptr ? m_header->node_count : 0;
+}
+
+template <typename T>
+typename mapped_graph<T>::size_type mapped_graph<T>::max_size() const noexcept
+{
+    return size();
+}
+
+template <typename T>
+bool mapped_graph<T>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename T>
+typename mapped_graph<T>::size_type mapped_graph<T>::edge_count() const noexcept
+{
+    return m_header != nullptr ? m_header->edge_count : 0;
+}
+
+template <typename T>
+std::set<typename mapped_graph<T>::value_type> mapped_graph<T>::get_adjacent_node_values(const value_type &node_value) const
+{
+    std::set<value_type> values;
+    const size_type index = find_index(node_value);
+    if (index == npos)
+        return values;
+    for (auto &&target : get_adjacent_node_indices(index))
+        values.insert((*this)[target]);
+    return values;
+}
+
+template <typename T>
+typename mapped_graph<T>::adjacent_nodes_view mapped_graph<T>::neighbors(const value_type &node_value) const noexcept
+{
+    return adjacent_nodes_view(begin(node_value), end(node_value));
+}
+#endif
@@ -0,0 +1,258 @@
+#ifndef GRAPH_INSTRUMENTATION_HPP
+#define GRAPH_INSTRUMENTATION_HPP
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+// Instrumentation policies for directed_graph, selected by its last template parameter.
+// no_instrumentation compiles every hook away; counting_instrumentation counts calls, the
+// elements scanned by find(), the adjacency entries visited by renumbering passes and the
+// growth of the node table and adjacency lists, and optionally records per-operation latency.
+
+enum class graph_operation
+{
+    insert,
+    insert_edge,
+    insert_edges,
+    erase_edge,
+    erase,
+    erase_range,
+    erase_batch,
+    find, // includes the lookups done by the other operations
+    assign,
+    clear,
+    compact,
+    equal,
+    count
+};
+
+inline constexpr std::size_t graph_operation_count = static_cast<std::size_t>(graph_operation::count);
+
+inline const char *to_string(graph_operation operation) noexcept
+{
+    constexpr const char *names[graph_operation_count] = {"insert", "insert_edge", "insert_edges", "erase_edge", "erase", "erase_range",
+                                                          "erase_batch", "find", "assign", "clear", "compact", "equal"};
+    return names[static_cast<std::size_t>(operation)];
+}
+
+// Latencies bucketed by powers of two: bucket b counts calls that took [2^b, 2^(b+1)) ns,
+// bucket 0 also takes everything below 1 ns and the last bucket everything above.
+struct latency_histogram
+{
+    static constexpr std::size_t bucket_count = 40;
+    std::array<std::uint64_t, bucket_count> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns = 0;
+
+    static constexpr std::size_t bucket_of(std::uint64_t ns) noexcept
+    {
+        const std::size_t bucket = ns == 0 ? 0 : std::bit_width(ns) - 1;
+        return bucket < bucket_count ? bucket : bucket_count - 1;
+    }
+};
+
+// Snapshot returned by directed_graph::stats().
+struct graph_stats
+{
+    std::array<std::uint64_t, graph_operation_count> calls{};
+    // nodes compared by a linear find(), one per lookup when the hash index is enabled
+    std::uint64_t find_scanned = 0;
+    // adjacency entries visited by remove_all_links_to and compaction
+    std::uint64_t links_scanned = 0;
+    // times the node table or an adjacency list had to grow
+    std::uint64_t allocations = 0;
+    // all empty unless latencies are recorded
+    std::array<latency_histogram, graph_operation_count> latency{};
+
+    std::uint64_t calls_of(graph_operation operation) const noexcept { return calls[static_cast<std::size_t>(operation)]; }
+    const latency_histogram &latency_of(graph_operation operation) const noexcept { return latency[static_cast<std::size_t>(operation)]; }
+
+    // Writes the snapshot as one JSON object, operations without calls are left out.
+    void write_json(std::ostream &out) const;
+};
+
+inline void graph_stats::write_json(std::ostream &out) const
+{
+    out << "{\"find_scanned\": " << find_scanned << ", \"links_scanned\": " << links_scanned << ", \"allocations\": " << allocations
+        << ", \"operations\": {";
+    bool first = true;
+    for (std::size_t op = 0; op < graph_operation_count; ++op)
+    {
+        if (calls[op] == 0)
+            continue;
+        out << (first ? "" : ", ") << "\"" << to_string(static_cast<graph_operation>(op)) << "\": {\"calls\": " << calls[op];
+        first = false;
+        const auto &histogram = latency[op];
+        if (histogram.count != 0)
+        {
+            out << ", \"total_ns\": " << histogram.total_ns << ", \"max_ns\": " << histogram.max_ns << ", \"buckets\": [";
+            for (std::size_t bucket = 0; bucket < latency_histogram::bucket_count; ++bucket)
+                out << (bucket == 0 ? "" : ", ") << histogram.buckets[bucket];
+            out << "]";
+        }
+        out << "}";
+    }
+    out << "}}";
+}
+
+// Default policy, every hook is an empty inline function and the member takes no space.
+struct no_instrumentation
+{
+    static constexpr bool enabled = false;
+
+    struct operation_scope
+    {
+    };
+
+    operation_scope operation(graph_operation) const noexcept { return {}; }
+    void count_find_scanned(std::size_t) const noexcept {}
+    void count_links_scanned(std::size_t) const noexcept {}
+    void count_allocation() const noexcept {}
+
+    graph_stats stats() const noexcept { return {}; }
+    void reset() noexcept {}
+};
+
+// Counts with relaxed atomics, so concurrent const lookups can be counted too.
+// RecordLatency additionally times every operation into a latency_histogram.
+// The counters belong to the graph object: copies and moved-to graphs start from zero.
+template <bool RecordLatency = false>
+class counting_instrumentation
+{
+public:
+    static constexpr bool enabled = true;
+
+    // Counts the call when created and, with RecordLatency, records its latency when destroyed.
+    class operation_scope
+    {
+    public:
+        operation_scope(const counting_instrumentation &owner, graph_operation operation) noexcept;
+        operation_scope(const operation_scope &) = delete;
+        operation_scope &operator=(const operation_scope &) = delete;
+        ~operation_scope();
+
+    private:
+        const counting_instrumentation &m_owner;
+        graph_operation m_operation;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    counting_instrumentation() = default;
+    counting_instrumentation(const counting_instrumentation &) noexcept {}
+    counting_instrumentation &operator=(const counting_instrumentation &) noexcept { return *this; }
+
+    operation_scope operation(graph_operation operation) const noexcept { return operation_scope(*this, operation); }
+    void count_find_scanned(std::size_t count) const noexcept { m_findScanned.fetch_add(count, std::memory_order_relaxed); }
+    void count_links_scanned(std::size_t count) const noexcept { m_linksScanned.fetch_add(count, std::memory_order_relaxed); }
+    void count_allocation() const noexcept { m_allocations.fetch_add(1, std::memory_order_relaxed); }
+
+    graph_stats stats() const noexcept;
+    void reset() noexcept;
+
+private:
+    struct atomic_histogram
+    {
+        std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> buckets{};
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> total_ns{0};
+        std::atomic<std::uint64_t> max_ns{0};
+    };
+    struct no_histograms
+    {
+    };
+
+    void record_latency(graph_operation operation, std::uint64_t ns) const noexcept;
+
+    mutable std::array<std::atomic<std::uint64_t>, graph_operation_count> m_calls{};
+    mutable std::atomic<std::uint64_t> m_findScanned{0};
+    mutable std::atomic<std::uint64_t> m_linksScanned{0};
+    mutable std::atomic<std::uint64_t> m_allocations{0};
+    [[no_unique_address]] mutable std::conditional_t<RecordLatency, std::array<atomic_histogram, graph_operation_count>, no_histograms> m_latency;
+};
+
+template <bool RecordLatency>
+counting_instrumentation<RecordLatency>::operation_scope::operation_scope(const counting_instrumentation &owner, graph_operation operation) noexcept
+    : m_owner(owner), m_operation(operation)
+{
+    m_owner.m_calls[static_cast<std::size_t>(operation)].fetch_add(1, std::memory_order_relaxed);
+    if constexpr (RecordLatency)
+        m_start = std::chrono::steady_clock::now();
+}
+
+template <bool RecordLatency>
+counting_instrumentation<RecordLatency>::operation_scope::~operation_scope()
+{
+    if constexpr (RecordLatency)
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_owner.record_latency(m_operation, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+}
+
+template <bool RecordLatency>
+void counting_instrumentation<RecordLatency>::record_latency(graph_operation operation, std::uint64_t ns) const noexcept
+{
+    if constexpr (RecordLatency)
+    {
+        auto &histogram = m_latency[static_cast<std::size_t>(operation)];
+        histogram.buckets[latency_histogram::bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        histogram.count.fetch_add(1, std::memory_order_relaxed);
+        histogram.total_ns.fetch_add(ns, std::memory_order_relaxed);
+        auto max_ns = histogram.max_ns.load(std::memory_order_relaxed);
+        while (ns > max_ns && !histogram.max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed))
+            ;
+    }
+}
+
+template <bool RecordLatency>
+graph_stats counting_instrumentation<RecordLatency>::stats() const noexcept
+{
+    graph_stats snapshot;
+    for (std::size_t op = 0; op < graph_operation_count; ++op)
+        snapshot.calls[op] = m_calls[op].load(std::memory_order_relaxed);
+    snapshot.find_scanned = m_findScanned.load(std::memory_order_relaxed);
+    snapshot.links_scanned = m_linksScanned.load(std::memory_order_relaxed);
+    snapshot.allocations = m_allocations.load(std::memory_order_relaxed);
+    if constexpr (RecordLatency)
+    {
+        for (std::size_t op = 0; op < graph_operation_count; ++op)
+        {
+            const auto &source = m_latency[op];
+            auto &target = snapshot.latency[op];
+            for (std::size_t bucket = 0; bucket < latency_histogram::bucket_count; ++bucket)
+                target.buckets[bucket] = source.buckets[bucket].load(std::memory_order_relaxed);
+            target.count = source.count.load(std::memory_order_relaxed);
+            target.total_ns = source.total_ns.load(std::memory_order_relaxed);
+            target.max_ns = source.max_ns.load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+template <bool RecordLatency>
+void counting_instrumentation<RecordLatency>::reset() noexcept
+{
+    for (auto &&calls : m_calls)
+        calls.store(0, std::memory_order_relaxed);
+    m_findScanned.store(0, std::memory_order_relaxed);
+    m_linksScanned.store(0, std::memory_order_relaxed);
+    m_allocations.store(0, std::memory_order_relaxed);
+    if constexpr (RecordLatency)
+    {
+        for (auto &&histogram : m_latency)
+        {
+            for (auto &&bucket : histogram.buckets)
+                bucket.store(0, std::memory_order_relaxed);
+            histogram.count.store(0, std::memory_order_relaxed);
+            histogram.total_ns.store(0, std::memory_order_relaxed);
+            histogram.max_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+#endif
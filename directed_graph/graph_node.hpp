@@ -1,16 +1,70 @@
 #ifndef GRAPH_NODE_HPP
 #define GRAPH_NODE_HPP
 #include <set>
+#include <memory>
+#include <memory_resource>
+#include <scoped_allocator>
+#include <utility>
+#include "small_flat_set.hpp"
+
+// The adjacency list type a graph with the given Allocator uses: a small_flat_set left on the
+// default std::allocator gets Allocator rebound to its keys, so every allocator reaches the
+// adjacency lists. Other adjacency lists are used as they are.
+template <typename AdjacencyList, typename Allocator>
+struct rebind_adjacency
+{
+    using type = AdjacencyList;
+};
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+struct rebind_adjacency<small_flat_set<Key, N, Compare, std::allocator<Key>>, Allocator>
+{
+    using type = small_flat_set<Key, N, Compare, typename std::allocator_traits<Allocator>::template rebind_alloc<Key>>;
+};
+
+template <typename AdjacencyList, typename Allocator>
+using rebind_adjacency_t = typename rebind_adjacency<AdjacencyList, Allocator>::type;
+
+// True for allocators whose construct() does uses-allocator construction by itself, i.e. hands
+// themselves on to the elements. Containers with any other allocator must pass it explicitly.
+template <typename Allocator>
+inline constexpr bool constructs_using_allocator_v = false;
+
+template <typename U>
+inline constexpr bool constructs_using_allocator_v<std::pmr::polymorphic_allocator<U>> = true;
+
+template <typename Outer, typename... Inner>
+inline constexpr bool constructs_using_allocator_v<std::scoped_allocator_adaptor<Outer, Inner...>> = true;
 // Grpah Node Implementation
-template <typename T>
+// AdjacencyList is a sorted set of node indices, e.g. small_flat_set (default) or std::set<std::size_t>.
+// The node is allocator-aware: when it is built through the uses-allocator protocol
+// (e.g. inside a container using std::pmr::polymorphic_allocator) the allocator
+// is handed on to the value and to the adjacency list.
+template <typename T, typename AdjacencyList = small_flat_set<std::size_t>, typename Allocator = std::allocator<T>>
 class graph_node
 {
 public:
-    using adjacency_list_type = std::set<std::size_t>;
+    using adjacency_list_type = AdjacencyList;
+    using allocator_type = Allocator;
     T m_data;
     adjacency_list_type m_adjacentNodeIndices;
     explicit graph_node(const T &t);
     explicit graph_node(T &&t);
+    // constructs the value in place from args
+    template <typename... Args>
+    explicit graph_node(std::in_place_t, Args &&...args);
+
+    // allocator-extended constructors
+    graph_node(const T &t, const Allocator &alloc);
+    graph_node(T &&t, const Allocator &alloc);
+    template <typename... Args>
+    graph_node(std::allocator_arg_t, const Allocator &alloc, std::in_place_t, Args &&...args);
+    graph_node(const graph_node &other) = default;
+    graph_node(graph_node &&other) = default;
+    graph_node(const graph_node &other, const Allocator &alloc);
+    graph_node(graph_node &&other, const Allocator &alloc);
+    graph_node &operator=(const graph_node &rhs) = default;
+    graph_node &operator=(graph_node &&rhs) = default;
 
     T &get() noexcept;
     const T &get() const noexcept;
@@ -24,50 +78,77 @@ public:
     void swap(graph_node &other_node) noexcept;
 };
 
-template <typename T>
-typename graph_node<T>::adjacency_list_type &graph_node<T>::get_adjacent_node_indices()
+template <typename T, typename AdjacencyList, typename Allocator>
+typename graph_node<T, AdjacencyList, Allocator>::adjacency_list_type &graph_node<T, AdjacencyList, Allocator>::get_adjacent_node_indices()
 {
     return m_adjacentNodeIndices;
 }
 
-template <typename T>
-const typename graph_node<T>::adjacency_list_type &graph_node<T>::get_adjacent_node_indices() const
+template <typename T, typename AdjacencyList, typename Allocator>
+const typename graph_node<T, AdjacencyList, Allocator>::adjacency_list_type &graph_node<T, AdjacencyList, Allocator>::get_adjacent_node_indices() const
 {
     return m_adjacentNodeIndices;
 }
 
-template <typename T>
-graph_node<T>::graph_node(const T &t) : m_data(t) {}
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(const T &t) : m_data(t) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(T &&t) : m_data(std::move(t)) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+template <typename... Args>
+graph_node<T, AdjacencyList, Allocator>::graph_node(std::in_place_t, Args &&...args) : m_data(std::forward<Args>(args)...) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(const T &t, const Allocator &alloc)
+    : m_data(std::make_obj_using_allocator<T>(alloc, t)), m_adjacentNodeIndices(std::make_obj_using_allocator<AdjacencyList>(alloc)) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(T &&t, const Allocator &alloc)
+    : m_data(std::make_obj_using_allocator<T>(alloc, std::move(t))), m_adjacentNodeIndices(std::make_obj_using_allocator<AdjacencyList>(alloc)) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+template <typename... Args>
+graph_node<T, AdjacencyList, Allocator>::graph_node(std::allocator_arg_t, const Allocator &alloc, std::in_place_t, Args &&...args)
+    : m_data(std::make_obj_using_allocator<T>(alloc, std::forward<Args>(args)...)), m_adjacentNodeIndices(std::make_obj_using_allocator<AdjacencyList>(alloc)) {}
+
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(const graph_node &other, const Allocator &alloc)
+    : m_data(std::make_obj_using_allocator<T>(alloc, other.m_data)),
+      m_adjacentNodeIndices(std::make_obj_using_allocator<AdjacencyList>(alloc, other.m_adjacentNodeIndices)) {}
 
-template <typename T>
-graph_node<T>::graph_node(T &&t) : m_data(std::move(t)) {}
+template <typename T, typename AdjacencyList, typename Allocator>
+graph_node<T, AdjacencyList, Allocator>::graph_node(graph_node &&other, const Allocator &alloc)
+    : m_data(std::make_obj_using_allocator<T>(alloc, std::move(other.m_data))),
+      m_adjacentNodeIndices(std::make_obj_using_allocator<AdjacencyList>(alloc, std::move(other.m_adjacentNodeIndices))) {}
 
-template <typename T>
-T &graph_node<T>::get() noexcept
+template <typename T, typename AdjacencyList, typename Allocator>
+T &graph_node<T, AdjacencyList, Allocator>::get() noexcept
 {
     return m_data;
 }
 
-template <typename T>
-const T &graph_node<T>::get() const noexcept
+template <typename T, typename AdjacencyList, typename Allocator>
+const T &graph_node<T, AdjacencyList, Allocator>::get() const noexcept
 {
     return m_data;
 }
 
-template <typename T>
-bool graph_node<T>::operator==(const graph_node &rhs) const
+template <typename T, typename AdjacencyList, typename Allocator>
+bool graph_node<T, AdjacencyList, Allocator>::operator==(const graph_node &rhs) const
 {
     return m_data == rhs.m_data && m_adjacentNodeIndices == rhs.m_adjacentNodeIndices;
 }
 
-template <typename T>
-bool graph_node<T>::operator!=(const graph_node &rhs) const
+template <typename T, typename AdjacencyList, typename Allocator>
+bool graph_node<T, AdjacencyList, Allocator>::operator!=(const graph_node &rhs) const
 {
     return !(*this == rhs);
 }
 
-template <typename T>
-void graph_node<T>::swap(graph_node &other_node) noexcept
+template <typename T, typename AdjacencyList, typename Allocator>
+void graph_node<T, AdjacencyList, Allocator>::swap(graph_node &other_node) noexcept
 {
     using std::swap;
 
@@ -0,0 +1,219 @@
+// Benchmark for interned_graph against directed_graph<std::string>.
+//
+//   g++ -std=c++20 -O2 -DNDEBUG interned_benchmark.cpp -o interned_benchmark
+//   ./interned_benchmark [--nodes N] [--edges E] [--length L] [--repeat R]
+//
+// Both graphs get the same random strings of L to 2 * L characters and the same random edges. The
+// times for inserting the nodes, the edges, looking up every value and iterating the nodes are the
+// best of --repeat runs. Before anything is reported the graphs are checked against each other, node
+// by node and neighbor by neighbor, and the views returned by the first inserts are checked to still
+// read their strings after all the others were added; a mismatch ends the run with exit code 1.
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "directed_graph.hpp"
+#include "interned_graph.hpp"
+
+struct interned_options
+{
+    std::size_t nodes = 200000;
+    std::size_t edges = 1000000;
+    std::size_t length = 24; // longer than the small string buffer
+    int repeat = 3;
+};
+
+using string_graph = directed_graph<std::string, string_hash, std::equal_to<>>;
+
+// keeps the compiler from dropping computations whose result is unused
+template <typename T>
+void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+std::vector<std::string> make_values(const interned_options &options)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::size_t> length(options.length, 2 * options.length);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> values(options.nodes);
+    for (std::size_t index = 0; index < values.size(); ++index)
+    {
+        // the index keeps the values distinct
+        values[index] = std::to_string(index) + "_";
+        while (values[index].size() < length(rng))
+            values[index] += static_cast<char>(letter(rng));
+    }
+    return values;
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> make_edges(const interned_options &options)
+{
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<std::size_t> node(0, options.nodes - 1);
+    std::vector<std::pair<std::size_t, std::size_t>> edges(options.edges);
+    for (auto &&edge : edges)
+        edge = {node(rng), node(rng)};
+    return edges;
+}
+
+// Best time of repeat runs of body on a fresh graph, in nanoseconds per operation.
+template <typename Graph, typename Setup, typename Body>
+double measure(int repeat, std::size_t ops, Setup setup, Body body)
+{
+    double best = 0;
+    for (int run = 0; run < repeat; ++run)
+    {
+        Graph graph;
+        setup(graph);
+        const auto start = std::chrono::steady_clock::now();
+        body(graph);
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || ns < best)
+            best = ns;
+    }
+    return best / static_cast<double>(std::max<std::size_t>(ops, 1));
+}
+
+template <typename Graph>
+void insert_nodes(Graph &graph, const std::vector<std::string> &values)
+{
+    for (auto &&value : values)
+        graph.insert(value);
+}
+
+template <typename Graph>
+void insert_edges(Graph &graph, const std::vector<std::string> &values, const std::vector<std::pair<std::size_t, std::size_t>> &edges)
+{
+    for (auto &&[from, to] : edges)
+        graph.insert_edge(values[from], values[to]);
+}
+
+// Whether both graphs hold the same values and every node has the same neighbors.
+bool same_graph(const interned_graph<> &interned, const string_graph &strings)
+{
+    if (interned.size() != strings.size() || interned.edge_count() != strings.edge_count())
+        return false;
+    for (auto &&value : strings)
+    {
+        if (!interned.contains(value))
+            return false;
+        const auto neighbors = interned.neighbors(value);
+        const std::set<std::string_view> lhs(std::begin(neighbors), std::end(neighbors));
+        const std::set<std::string_view> rhs(strings.begin(value), strings.end(value));
+        if (lhs != rhs)
+            return false;
+    }
+    return true;
+}
+
+int usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--nodes N] [--edges E] [--length L] [--repeat R]\n";
+    return 2;
+}
+
+// Driver code
+int main(int argc, char *argv[])
+{
+    interned_options options;
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string_view arg = argv[index];
+        if (index + 1 >= argc)
+            return usage(argv[0]);
+        const char *value = argv[++index];
+        if (arg == "--nodes")
+            options.nodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--edges")
+            options.edges = std::strtoull(value, nullptr, 10);
+        else if (arg == "--length")
+            options.length = std::strtoull(value, nullptr, 10);
+        else if (arg == "--repeat")
+            options.repeat = std::atoi(value);
+        else
+            return usage(argv[0]);
+    }
+    if (options.nodes == 0 || options.repeat < 1)
+        return usage(argv[0]);
+
+    const auto values = make_values(options);
+    const auto edges = make_edges(options);
+
+    interned_graph<> interned;
+    // views of the first values, taken while the pool is still small
+    std::vector<std::string_view> early;
+    for (std::size_t index = 0; index < values.size(); ++index)
+    {
+        const auto view = *interned.insert(values[index]).first;
+        if (index < 1000)
+            early.push_back(view);
+    }
+    insert_edges(interned, values, edges);
+    string_graph strings;
+    insert_nodes(strings, values);
+    insert_edges(strings, values, edges);
+    for (std::size_t index = 0; index < early.size(); ++index)
+    {
+        if (early[index] != values[index])
+        {
+            std::cerr << "interned_graph: the view of node " << index << " changed while nodes were inserted\n";
+            return 1;
+        }
+    }
+    if (!same_graph(interned, strings) || !same_graph(interned_graph<>(strings), strings))
+    {
+        std::cerr << "interned_graph: differs from directed_graph<std::string>\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(14) << "op" << std::right << std::setw(16) << "interned ns/op" << std::setw(16)
+              << "string ns/op" << std::endl;
+    const auto report = [](const char *op, double interned_ns, double strings_ns)
+    {
+        std::cout << std::left << std::setw(14) << op << std::right << std::fixed << std::setprecision(1) << std::setw(16)
+                  << interned_ns << std::setw(16) << strings_ns << std::endl;
+    };
+    const auto no_setup = [](auto &) {};
+    const auto with_nodes = [&values](auto &graph)
+    { insert_nodes(graph, values); };
+    const auto with_edges = [&](auto &graph)
+    {
+        insert_nodes(graph, values);
+        insert_edges(graph, values, edges);
+    };
+
+    report("insert", measure<interned_graph<>>(options.repeat, values.size(), no_setup, with_nodes),
+           measure<string_graph>(options.repeat, values.size(), no_setup, with_nodes));
+    report("insert_edge", measure<interned_graph<>>(options.repeat, edges.size(), with_nodes, [&](auto &graph)
+                                                    { insert_edges(graph, values, edges); }),
+           measure<string_graph>(options.repeat, edges.size(), with_nodes, [&](auto &graph)
+                                 { insert_edges(graph, values, edges); }));
+    const auto find_all = [&values](auto &graph)
+    {
+        std::size_t found = 0;
+        for (auto &&value : values)
+            found += graph.contains(value);
+        do_not_optimize(found);
+    };
+    report("contains", measure<interned_graph<>>(options.repeat, values.size(), with_nodes, find_all),
+           measure<string_graph>(options.repeat, values.size(), with_nodes, find_all));
+    const auto iterate = [](auto &graph)
+    {
+        std::size_t bytes = 0;
+        for (auto &&value : graph)
+            bytes += std::string_view(value).size();
+        do_not_optimize(bytes);
+    };
+    report("iterate", measure<interned_graph<>>(options.repeat, values.size(), with_edges, iterate),
+           measure<string_graph>(options.repeat, values.size(), with_edges, iterate));
+    return 0;
+}
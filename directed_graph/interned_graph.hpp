@@ -0,0 +1,578 @@
+#ifndef INTERNED_GRAPH_HPP
+#define INTERNED_GRAPH_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "small_flat_set.hpp"
+#include "const_indexed_node_iterator.hpp"
+#include "const_adjacent_nodes_iterator.hpp"
+
+// Interned strings: every distinct string is stored once and named by its id, ids being 0, 1, ... in
+// insertion order. The strings are copied back to back into blocks of at least block_size bytes that
+// are never moved or resized, so a string_view handed out stays valid while more strings are added
+// and when the pool is moved or swapped, until clear() or destruction. Lookups go through an open addressing table with linear probing over 8 byte slots that hold the
+// id and the upper half of the hash, so a probe rejects almost every other string without touching
+// the arena. Strings cannot be removed one by one, only all at once by clear().
+template <typename Hash = std::hash<std::string_view>>
+class string_pool
+{
+public:
+    using size_type = std::size_t;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    // blocks of string data are allocated with at least this many bytes
+    static constexpr size_type block_size = 64 * 1024;
+
+    string_pool() = default;
+    // The copy stores the strings in blocks of its own, the ids stay the same.
+    string_pool(const string_pool &other);
+    string_pool(string_pool &&other) noexcept = default;
+    string_pool &operator=(const string_pool &other);
+    string_pool &operator=(string_pool &&other) noexcept = default;
+
+    // Id of value, which is added if it is new; second is true if it was added.
+    std::pair<size_type, bool> intern(std::string_view value);
+    // Id of value, npos if it was never interned.
+    size_type find(std::string_view value) const noexcept;
+
+    std::string_view operator[](size_type id) const noexcept;
+    size_type size() const noexcept { return m_views.size(); }
+    // ids are stored in 32 bits
+    size_type max_size() const noexcept { return std::numeric_limits<std::uint32_t>::max() - 1; }
+    bool empty() const noexcept { return size() == 0; }
+    // Bytes of string data stored, not counting the unused tails of the blocks.
+    size_type arena_size() const noexcept { return m_bytes; }
+
+    // Room for string_count strings of string_bytes bytes in total without allocating.
+    void reserve(size_type string_count, size_type string_bytes);
+    void clear() noexcept;
+    void swap(string_pool &other) noexcept;
+
+private:
+    struct slot
+    {
+        std::uint32_t m_tag; // upper 32 bits of the hash
+        std::uint32_t m_id;  // id + 1, 0 for an empty slot
+    };
+
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    // free room at the end of m_blocks.back()
+    char *m_free = nullptr;
+    size_type m_freeSize = 0;
+    size_type m_bytes = 0;
+    // m_views[id] points into one of the blocks
+    std::vector<std::string_view> m_views;
+    std::vector<slot> m_slots;
+    [[no_unique_address]] Hash m_hash;
+
+    static constexpr size_type min_slot_count = 16;
+    // grow once more than 7 / 10 of the slots are taken
+    static bool overloaded(size_type count, size_type slot_count) noexcept { return count * 10 > slot_count * 7; }
+    static std::uint32_t tag_of(std::size_t hash) noexcept { return static_cast<std::uint32_t>(static_cast<std::uint64_t>(hash) >> 32); }
+
+    // Starts a block with room for at least bytes bytes, the rest of the current one stays unused.
+    void add_block(size_type bytes);
+    // Copies value into the blocks. Only the view is returned, m_views is left to the caller.
+    std::string_view store(std::string_view value);
+    // Slot holding value, or the empty slot where it would go.
+    size_type probe(std::string_view value, std::size_t hash) const noexcept;
+    void rehash(size_type slot_count);
+};
+
+// Directed graph over interned strings, for graphs with many string nodes. The values live in one
+// string_pool and nodes are their ids, so no node owns a std::string: iteration walks two arrays,
+// find() compares hashes before bytes and the strings sit densely in large blocks instead of one heap
+// allocation per std::string that does not fit its small buffer. Values are handed out as
+// std::string_view; see string_pool, they stay valid while nodes are inserted, until the graph is
+// cleared or destroyed. The node iterators hand them out by value and are therefore input iterators.
+// Nodes cannot be erased one by one, edges can. Offers the query surface of csr_graph, so the
+// algorithms in graph_algorithms.hpp work on it as well.
+template <typename Adjacency = small_flat_set<std::size_t>, typename Hash = std::hash<std::string_view>>
+class interned_graph
+{
+public:
+    string_pool<Hash> m_strings;
+    // m_adjacency[id] holds the sorted adjacency indices of node id
+    std::vector<Adjacency> m_adjacency;
+
+public:
+    // public type aliases
+    using value_type = std::string_view;
+    using reference = std::string_view;
+    using const_reference = std::string_view;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using adjacency_list_type = Adjacency;
+
+    // public iterator-related type aliases, values cannot be modified
+    using const_iterator = const_indexed_node_iterator<interned_graph>;
+    using iterator = const_iterator;
+    using const_iterator_adjacent_nodes = const_adjacent_nodes_iterator<interned_graph>;
+    using iterator_adjacent_nodes = const_iterator_adjacent_nodes;
+    using adjacent_nodes_view = std::ranges::subrange<const_iterator_adjacent_nodes>;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    interned_graph() = default;
+    // ctor taking a range of values convertible to std::string_view, duplicates are dropped
+    template <typename Iter>
+    interned_graph(Iter first, Iter last);
+    interned_graph(std::initializer_list<std::string_view> init);
+    // Interns the values and copies the edges of a graph of strings, e.g. directed_graph<std::string>.
+    // Tombstoned nodes are left out and the rest renumbered the way compact() would do it.
+    template <typename DirectedGraph>
+        requires requires(const DirectedGraph &graph) { graph.m_nodes; }
+    explicit interned_graph(const DirectedGraph &graph);
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    // return iterator to the list of adjacent nodes for the given node
+    // return a default constructed iterator as the end iterator if the value is not found
+    const_iterator_adjacent_nodes begin(std::string_view node_value) const noexcept;
+    const_iterator_adjacent_nodes end(std::string_view node_value) const noexcept;
+    const_iterator_adjacent_nodes cbegin(std::string_view node_value) const noexcept;
+    const_iterator_adjacent_nodes cend(std::string_view node_value) const noexcept;
+    // Same semantics as directed_graph::neighbors
+    adjacent_nodes_view neighbors(std::string_view node_value) const noexcept;
+
+    // Returns true if a new node with the given value has been added, the index of the node is its id.
+    std::pair<iterator, bool> insert(std::string_view node_value);
+    // Returns true if the edge was successfully created, false otherwise
+    bool insert_edge(std::string_view from_node_value, std::string_view to_node_value);
+    // Returns true if the given edge was erased, false otherwise
+    bool erase_edge(std::string_view from_node_value, std::string_view to_node_value);
+
+    // Index of the node with the given value, npos if there is none.
+    size_type find_index(std::string_view node_value) const noexcept;
+    bool contains(std::string_view node_value) const noexcept;
+
+    const_reference operator[](size_type index) const noexcept;
+    const_reference at(size_type index) const;
+
+    // Sorted adjacency indices of the node at the given index.
+    const adjacency_list_type &get_adjacent_node_indices(size_type index) const noexcept;
+
+    // Same semantics as directed_graph::operator==
+    bool operator==(const interned_graph &rhs) const;
+    bool operator!=(const interned_graph &rhs) const;
+
+    // Room for node_count nodes holding string_bytes bytes of values in total.
+    void reserve(size_type node_count, size_type string_bytes = 0);
+    void clear() noexcept;
+    void swap(interned_graph &other_graph) noexcept;
+    size_type size() const noexcept;
+    size_type max_size() const noexcept;
+    bool empty() const noexcept;
+    size_type edge_count() const noexcept;
+};
+
+template <typename Hash>
+typename string_pool<Hash>::size_type string_pool<Hash>::probe(std::string_view value, std::size_t hash) const noexcept
+{
+    const size_type mask = m_slots.size() - 1;
+    const std::uint32_t tag = tag_of(hash);
+    for (size_type position = hash & mask;; position = (position + 1) & mask)
+    {
+        const slot &candidate = m_slots[position];
+        if (candidate.m_id == 0 || (candidate.m_tag == tag && (*this)[candidate.m_id - 1] == value))
+            return position;
+    }
+}
+
+template <typename Hash>
+std::pair<typename string_pool<Hash>::size_type, bool> string_pool<Hash>::intern(std::string_view value)
+{
+    if (overloaded(size() + 1, m_slots.size()))
+    {
+        if (size() >= max_size())
+            throw std::length_error("string_pool: too many strings");
+        rehash(std::max(min_slot_count, m_slots.size() * 2));
+    }
+    const std::size_t hash = m_hash(value);
+    slot &found = m_slots[probe(value, hash)];
+    if (found.m_id != 0)
+        return {found.m_id - 1, false};
+
+    // value may point into a block itself, blocks never move so it stays readable while copied
+    m_views.push_back(store(value));
+    found = slot{tag_of(hash), static_cast<std::uint32_t>(size())};
+    return {size() - 1, true};
+}
+
+template <typename Hash>
+void string_pool<Hash>::add_block(size_type bytes)
+{
+    const size_type capacity = std::max(bytes, block_size);
+    m_blocks.push_back(std::make_unique_for_overwrite<char[]>(capacity));
+    m_free = m_blocks.back().get();
+    m_freeSize = capacity;
+}
+
+template <typename Hash>
+std::string_view string_pool<Hash>::store(std::string_view value)
+{
+    if (value.size() > m_freeSize)
+        add_block(value.size());
+    char *data = m_free;
+    std::copy(std::begin(value), std::end(value), data);
+    m_free += value.size();
+    m_freeSize -= value.size();
+    m_bytes += value.size();
+    return std::string_view(data, value.size());
+}
+
+template <typename Hash>
+string_pool<Hash>::string_pool(const string_pool &other) : m_slots(other.m_slots), m_hash(other.m_hash)
+{
+    m_views.reserve(other.size());
+    if (other.m_bytes != 0)
+        add_block(other.m_bytes);
+    for (auto &&value : other.m_views)
+        m_views.push_back(store(value));
+}
+
+template <typename Hash>
+string_pool<Hash> &string_pool<Hash>::operator=(const string_pool &other)
+{
+    string_pool copy(other);
+    swap(copy);
+    return *this;
+}
+
+template <typename Hash>
+typename string_pool<Hash>::size_type string_pool<Hash>::find(std::string_view value) const noexcept
+{
+    if (m_slots.empty())
+        return npos;
+    const slot &found = m_slots[probe(value, m_hash(value))];
+    return found.m_id != 0 ? found.m_id - 1 : npos;
+}
+
+template <typename Hash>
+std::string_view string_pool<Hash>::operator[](size_type id) const noexcept
+{
+    return m_views[id];
+}
+
+template <typename Hash>
+void string_pool<Hash>::rehash(size_type slot_count)
+{
+    // the hashes are not kept, every string is hashed again from the blocks
+    std::vector<slot> slots(slot_count, slot{0, 0});
+    const size_type mask = slot_count - 1;
+    for (size_type id = 0; id < size(); ++id)
+    {
+        const std::size_t hash = m_hash((*this)[id]);
+        size_type position = hash & mask;
+        while (slots[position].m_id != 0)
+            position = (position + 1) & mask;
+        slots[position] = slot{tag_of(hash), static_cast<std::uint32_t>(id + 1)};
+    }
+    m_slots.swap(slots);
+}
+
+template <typename Hash>
+void string_pool<Hash>::reserve(size_type string_count, size_type string_bytes)
+{
+    if (string_bytes > m_freeSize)
+        add_block(string_bytes);
+    m_views.reserve(string_count);
+    size_type slot_count = std::max(min_slot_count, m_slots.size());
+    while (overloaded(string_count, slot_count))
+        slot_count *= 2;
+    if (slot_count != m_slots.size())
+        rehash(slot_count);
+}
+
+template <typename Hash>
+void string_pool<Hash>::clear() noexcept
+{
+    m_blocks.clear();
+    m_free = nullptr;
+    m_freeSize = 0;
+    m_bytes = 0;
+    m_views.clear();
+    m_slots.clear();
+}
+
+template <typename Hash>
+void string_pool<Hash>::swap(string_pool &other) noexcept
+{
+    using std::swap;
+
+    swap(m_blocks, other.m_blocks);
+    swap(m_free, other.m_free);
+    swap(m_freeSize, other.m_freeSize);
+    swap(m_bytes, other.m_bytes);
+    swap(m_views, other.m_views);
+    swap(m_slots, other.m_slots);
+    swap(m_hash, other.m_hash);
+}
+
+template <typename Adjacency, typename Hash>
+template <typename Iter>
+interned_graph<Adjacency, Hash>::interned_graph(Iter first, Iter last)
+{
+    for (auto iter = first; iter != last; ++iter)
+        insert(*iter);
+}
+
+template <typename Adjacency, typename Hash>
+interned_graph<Adjacency, Hash>::interned_graph(std::initializer_list<std::string_view> init) : interned_graph(std::begin(init), std::end(init)) {}
+
+template <typename Adjacency, typename Hash>
+template <typename DirectedGraph>
+    requires requires(const DirectedGraph &graph) { graph.m_nodes; }
+interned_graph<Adjacency, Hash>::interned_graph(const DirectedGraph &graph)
+{
+    const auto &nodes = graph.m_nodes;
+    constexpr size_t erased = static_cast<size_t>(-1);
+    std::vector<size_t> remap(nodes.size(), erased);
+    size_t string_bytes = 0;
+    for (size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (!graph.is_erased(index))
+            string_bytes += std::string_view(nodes[index].get()).size();
+    }
+    reserve(graph.size(), string_bytes);
+
+    // values are unique in the source graph, so ids come out in the order of the live nodes
+    for (size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (!graph.is_erased(index))
+            remap[index] = m_strings.intern(std::string_view(nodes[index].get())).first;
+    }
+    m_adjacency.resize(m_strings.size());
+    for (size_t index = 0; index < nodes.size(); ++index)
+    {
+        if (remap[index] == erased)
+            continue;
+        // remap is monotonic, so the targets are appended in order
+        auto &indices = m_adjacency[remap[index]];
+        for (auto &&target : nodes[index].get_adjacent_node_indices())
+        {
+            if (remap[target] != erased)
+                indices.insert(std::end(indices), remap[target]);
+        }
+    }
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator interned_graph<Adjacency, Hash>::begin() const noexcept
+{
+    return const_iterator(0, this);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator interned_graph<Adjacency, Hash>::end() const noexcept
+{
+    return const_iterator(size(), this);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator interned_graph<Adjacency, Hash>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator interned_graph<Adjacency, Hash>::cend() const noexcept
+{
+    return end();
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator_adjacent_nodes interned_graph<Adjacency, Hash>::begin(std::string_view node_value) const noexcept
+{
+    const size_type index = find_index(node_value);
+    if (index == npos) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    return const_iterator_adjacent_nodes(std::cbegin(m_adjacency[index]), this);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator_adjacent_nodes interned_graph<Adjacency, Hash>::end(std::string_view node_value) const noexcept
+{
+    const size_type index = find_index(node_value);
+    if (index == npos) // return a default constructed end iterator
+        return const_iterator_adjacent_nodes();
+    return const_iterator_adjacent_nodes(std::cend(m_adjacency[index]), this);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator_adjacent_nodes interned_graph<Adjacency, Hash>::cbegin(std::string_view node_value) const noexcept
+{
+    return begin(node_value);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_iterator_adjacent_nodes interned_graph<Adjacency, Hash>::cend(std::string_view node_value) const noexcept
+{
+    return end(node_value);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::adjacent_nodes_view interned_graph<Adjacency, Hash>::neighbors(std::string_view node_value) const noexcept
+{
+    return adjacent_nodes_view(begin(node_value), end(node_value));
+}
+
+template <typename Adjacency, typename Hash>
+std::pair<typename interned_graph<Adjacency, Hash>::iterator, bool> interned_graph<Adjacency, Hash>::insert(std::string_view node_value)
+{
+    const auto [id, inserted] = m_strings.intern(node_value);
+    if (inserted)
+    {
+        // a new string always gets the next id, so the adjacency lists grow in step with the pool
+        m_adjacency.emplace_back();
+    }
+    return std::make_pair(iterator(id, this), inserted);
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::insert_edge(std::string_view from_node_value, std::string_view to_node_value)
+{
+    const size_type from = find_index(from_node_value);
+    const size_type to = find_index(to_node_value);
+    if (from == npos || to == npos)
+        return false;
+    return m_adjacency[from].insert(to).second;
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::erase_edge(std::string_view from_node_value, std::string_view to_node_value)
+{
+    const size_type from = find_index(from_node_value);
+    const size_type to = find_index(to_node_value);
+    if (from == npos || to == npos)
+        return false; // nothing to erase
+    return m_adjacency[from].erase(to) != 0;
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::size_type interned_graph<Adjacency, Hash>::find_index(std::string_view node_value) const noexcept
+{
+    return m_strings.find(node_value);
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::contains(std::string_view node_value) const noexcept
+{
+    return find_index(node_value) != npos;
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_reference interned_graph<Adjacency, Hash>::operator[](size_type index) const noexcept
+{
+    return m_strings[index];
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::const_reference interned_graph<Adjacency, Hash>::at(size_type index) const
+{
+    if (index >= size())
+        throw std::out_of_range("interned_graph::at");
+    return m_strings[index];
+}
+
+template <typename Adjacency, typename Hash>
+const typename interned_graph<Adjacency, Hash>::adjacency_list_type &interned_graph<Adjacency, Hash>::get_adjacent_node_indices(size_type index) const noexcept
+{
+    return m_adjacency[index];
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::operator==(const interned_graph &rhs) const
+{
+    if (size() != rhs.size() || edge_count() != rhs.edge_count())
+        return false;
+
+    // ids of the lhs nodes in rhs, looked up once
+    std::vector<size_type> remap(size());
+    for (size_type index = 0; index < size(); ++index)
+    {
+        remap[index] = rhs.find_index(m_strings[index]);
+        if (remap[index] == npos)
+            return false;
+    }
+    for (size_type index = 0; index < size(); ++index)
+    {
+        const auto &lhs_indices = m_adjacency[index];
+        const auto &rhs_indices = rhs.m_adjacency[remap[index]];
+        if (lhs_indices.size() != rhs_indices.size())
+            return false;
+        for (auto &&target : lhs_indices)
+        {
+            if (!rhs_indices.contains(remap[target]))
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::operator!=(const interned_graph &rhs) const
+{
+    return !(*this == rhs);
+}
+
+template <typename Adjacency, typename Hash>
+void interned_graph<Adjacency, Hash>::reserve(size_type node_count, size_type string_bytes)
+{
+    m_strings.reserve(node_count, string_bytes);
+    m_adjacency.reserve(node_count);
+}
+
+template <typename Adjacency, typename Hash>
+void interned_graph<Adjacency, Hash>::clear() noexcept
+{
+    m_strings.clear();
+    m_adjacency.clear();
+}
+
+template <typename Adjacency, typename Hash>
+void interned_graph<Adjacency, Hash>::swap(interned_graph &other) noexcept
+{
+    m_strings.swap(other.m_strings);
+    m_adjacency.swap(other.m_adjacency);
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::size_type interned_graph<Adjacency, Hash>::size() const noexcept
+{
+    return m_strings.size();
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::size_type interned_graph<Adjacency, Hash>::max_size() const noexcept
+{
+    return m_strings.max_size();
+}
+
+template <typename Adjacency, typename Hash>
+bool interned_graph<Adjacency, Hash>::empty() const noexcept
+{
+    return m_strings.empty();
+}
+
+template <typename Adjacency, typename Hash>
+typename interned_graph<Adjacency, Hash>::size_type interned_graph<Adjacency, Hash>::edge_count() const noexcept
+{
+    size_type count = 0;
+    for (auto &&indices : m_adjacency)
+        count += indices.size();
+    return count;
+}
+#endif
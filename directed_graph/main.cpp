@@ -4,37 +4,17 @@
 #include "directed_graph.hpp"
 #include "const_directed_graph_iterator.hpp"
 #include "const_adjacent_nodes_iterator.hpp"
-#include "adjacent_nodes_iterator.hpp"
+#include "graph_export.hpp"
 
-template <typename T>
-void to_dot(const directed_graph<T> &graph, std::string graph_name)
+template <typename DirectedGraph>
+void to_dot(const DirectedGraph &graph, std::string graph_name)
 {
-    std::cout << "digraph" << graph_name << "{" << std::endl;
-
-    for (auto &&node : graph)
-    {
-
-        const auto adjacent_nodes = graph.get_adjacent_node_values(node);
-        const auto b = adjacent_nodes.cbegin();
-        const auto e = adjacent_nodes.cend();
-        if (b == e)
-        {
-            std::cout << node << std::endl;
-        }
-        else
-        {
-            for (auto iter = b; iter != e; ++iter)
-            {
-                std::cout << node << " -> " << *iter << std::endl;
-            }
-        }
-    }
-    std::cout << "}" << std::endl;
+    export_graph(graph, std::cout, {export_format::dot, std::move(graph_name)});
 }
 
 // standalone swap function
-template <typename T>
-void swap(directed_graph<T> &first, directed_graph<T> &second)
+template <typename T, typename Hash, typename KeyEqual, typename Adjacency, typename Allocator, typename Instrumentation>
+void swap(directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation> &first, directed_graph<T, Hash, KeyEqual, Adjacency, Allocator, Instrumentation> &second)
 {
     first.swap(second);
 }
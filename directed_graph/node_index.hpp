@@ -0,0 +1,177 @@
+#ifndef NODE_INDEX_HPP
+#define NODE_INDEX_HPP
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+// Placeholder for the value -> index hash index when it is disabled (Hash = void)
+struct no_node_index
+{
+    no_node_index() = default;
+    template <typename Allocator>
+    explicit no_node_index(const Allocator &) noexcept {}
+
+    template <typename Key>
+    static constexpr bool is_lookup_key = false;
+};
+
+// Transparent hash for strings: std::string, std::string_view and string literals hash alike, so with
+// string_hash and std::equal_to<> a graph of strings can be queried with any of them without allocating.
+struct string_hash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+};
+
+// value -> index hash index used by the graphs for O(1) average node lookup.
+// Only the index of every node and the hash of its value are stored, the values stay in the graph's
+// own node storage. Every lookup therefore takes value_at, a callable returning the value of the node
+// at an index that is in the index. The stored hash lets the table rehash without value_at.
+template <typename T, typename Hash, typename KeyEqual, typename Allocator = std::allocator<T>>
+class node_index
+{
+    struct entry
+    {
+        std::size_t m_hash;
+        // renumber() changes it in place, the value and with it the hash stay the same
+        mutable std::size_t m_index;
+    };
+
+    template <typename Key, typename ValueAt>
+    struct lookup
+    {
+        const Key &m_key;
+        std::size_t m_hash;
+        const KeyEqual &m_equal;
+        const ValueAt &m_valueAt;
+
+        bool matches(const entry &indexed) const { return indexed.m_hash == m_hash && m_equal(m_valueAt(indexed.m_index), m_key); }
+    };
+
+    struct entry_hash
+    {
+        using is_transparent = void;
+        std::size_t operator()(const entry &indexed) const noexcept { return indexed.m_hash; }
+        template <typename Key, typename ValueAt>
+        std::size_t operator()(const lookup<Key, ValueAt> &key) const noexcept { return key.m_hash; }
+    };
+
+    struct entry_equal
+    {
+        using is_transparent = void;
+        // entries are only ever compared with each other for the same node
+        bool operator()(const entry &lhs, const entry &rhs) const noexcept { return lhs.m_index == rhs.m_index; }
+        template <typename Key, typename ValueAt>
+        bool operator()(const lookup<Key, ValueAt> &key, const entry &indexed) const { return key.matches(indexed); }
+        template <typename Key, typename ValueAt>
+        bool operator()(const entry &indexed, const lookup<Key, ValueAt> &key) const { return key.matches(indexed); }
+    };
+
+    using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+    using entry_set = std::unordered_set<entry, entry_hash, entry_equal, entry_allocator>;
+
+public:
+    using size_type = std::size_t;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    // Key can be looked up as it is, otherwise the graph converts it to T first.
+    template <typename Key>
+    static constexpr bool is_lookup_key = std::is_same_v<Key, T> ||
+                                          (requires { typename Hash::is_transparent; typename KeyEqual::is_transparent; } &&
+                                           std::is_invocable_r_v<std::size_t, const Hash &, const Key &> &&
+                                           std::is_invocable_r_v<bool, const KeyEqual &, const T &, const Key &>);
+
+    node_index() = default;
+    explicit node_index(const Allocator &alloc) : m_entries(entry_allocator(alloc)) {}
+
+    // Index of the node equal to key, npos if there is none.
+    template <typename Key, typename ValueAt>
+    size_type find(const Key &key, const ValueAt &value_at) const;
+    // Adds index as the node of key unless a node equal to key is indexed already; the node at index
+    // need not exist yet. Returns the index of the node equal to key and whether it was added.
+    template <typename Key, typename ValueAt>
+    std::pair<size_type, bool> try_emplace(const Key &key, size_type index, const ValueAt &value_at);
+    // Adds index as the node of key, which the caller knows is not indexed yet, without a lookup.
+    template <typename Key>
+    void insert_absent(const Key &key, size_type index) { m_entries.insert(entry{static_cast<std::size_t>(m_hash(key)), index}); }
+    // Removes the node equal to key, returns whether there was one.
+    template <typename Key, typename ValueAt>
+    bool erase(const Key &key, const ValueAt &value_at);
+    // Replaces every stored index by renumber(index), for nodes that moved in the graph's storage.
+    template <typename Renumber>
+    void renumber(Renumber renumber);
+
+    size_type size() const noexcept { return m_entries.size(); }
+    bool empty() const noexcept { return m_entries.empty(); }
+    void clear() noexcept { m_entries.clear(); }
+    void reserve(size_type count) { m_entries.reserve(count); }
+    void rehash(size_type buckets) { m_entries.rehash(buckets); }
+
+    void swap(node_index &other) noexcept
+    {
+        using std::swap;
+        swap(m_entries, other.m_entries);
+        swap(m_hash, other.m_hash);
+        swap(m_equal, other.m_equal);
+    }
+    friend void swap(node_index &lhs, node_index &rhs) noexcept { lhs.swap(rhs); }
+
+private:
+    entry_set m_entries;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+
+    template <typename Key, typename ValueAt>
+    lookup<Key, ValueAt> make_lookup(const Key &key, const ValueAt &value_at) const
+    {
+        return {key, static_cast<std::size_t>(m_hash(key)), m_equal, value_at};
+    }
+};
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Key, typename ValueAt>
+typename node_index<T, Hash, KeyEqual, Allocator>::size_type node_index<T, Hash, KeyEqual, Allocator>::find(const Key &key, const ValueAt &value_at) const
+{
+    const auto found = m_entries.find(make_lookup(key, value_at));
+    return found == std::end(m_entries) ? npos : found->m_index;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Key, typename ValueAt>
+std::pair<typename node_index<T, Hash, KeyEqual, Allocator>::size_type, bool> node_index<T, Hash, KeyEqual, Allocator>::try_emplace(const Key &key, size_type index, const ValueAt &value_at)
+{
+    const auto key_lookup = make_lookup(key, value_at);
+    const auto found = m_entries.find(key_lookup);
+    if (found != std::end(m_entries))
+        return {found->m_index, false};
+    m_entries.insert(entry{key_lookup.m_hash, index});
+    return {index, true};
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Key, typename ValueAt>
+bool node_index<T, Hash, KeyEqual, Allocator>::erase(const Key &key, const ValueAt &value_at)
+{
+    const auto found = m_entries.find(make_lookup(key, value_at));
+    if (found == std::end(m_entries))
+        return false;
+    m_entries.erase(found);
+    return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Renumber>
+void node_index<T, Hash, KeyEqual, Allocator>::renumber(Renumber renumber)
+{
+    for (auto &&indexed : m_entries)
+        indexed.m_index = renumber(indexed.m_index);
+}
+
+// value -> index hash index used by the graphs, no_node_index without a Hash
+template <typename T, typename Hash, typename KeyEqual, typename Allocator = std::allocator<T>>
+using node_index_t = std::conditional_t<!std::is_void_v<Hash>, node_index<T, Hash, KeyEqual, Allocator>, no_node_index>;
+#endif
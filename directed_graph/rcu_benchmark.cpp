@@ -0,0 +1,272 @@
+// Read scaling benchmark for rcu_graph.
+//
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread rcu_benchmark.cpp -o rcu_benchmark
+//   ./rcu_benchmark [--nodes N] [--edges E] [--updates U] [--batch B] [--max-threads T] [--repeat R] [--json FILE]
+//
+// For 1, 2, 4, ... up to --max-threads reader threads (at most 64), every reader loops over read()
+// sections looking up random nodes, and takes a snapshot() every few reads that it keeps until the
+// next one, while one writer publishes U updates of B new edges each. Update v also inserts the
+// marker node N + v, so every read checks that its version holds its own marker and not the next
+// one, and that versions never go back. Once the readers are gone reclaim() must leave no retired
+// version behind. A failed check ends the run with exit code 1.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "directed_graph.hpp"
+#include "rcu_graph.hpp"
+
+struct read_options
+{
+    std::size_t nodes = 100000;
+    std::size_t edges = 500000; // in the initial graph
+    std::size_t updates = 50;
+    std::size_t batch = 1000; // edges per update
+    std::size_t max_threads = 64;
+    int repeat = 3;
+    std::string json_path;
+};
+
+struct read_result
+{
+    std::size_t threads;
+    std::size_t reads;
+    std::size_t snapshots;
+    double seconds;
+    double reads_per_sec;
+    double reads_per_sec_per_thread;
+};
+
+using graph_type = directed_graph<int>;
+
+// keeps the compiler from dropping computations whose result is unused
+template <typename T>
+void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Reads between two snapshots of a reader.
+constexpr std::size_t snapshot_interval = 64;
+
+// The e-th edge of the graph, distinct for every e below nodes * (nodes - 1).
+std::pair<int, int> nth_edge(std::size_t e, std::size_t nodes)
+{
+    const std::size_t from = e % nodes;
+    const std::size_t to = (from + 1 + e / nodes % (nodes - 1)) % nodes;
+    return {static_cast<int>(from), static_cast<int>(to)};
+}
+
+int marker(const read_options &options, std::uint64_t version)
+{
+    return static_cast<int>(options.nodes + version);
+}
+
+graph_type make_initial(const read_options &options)
+{
+    graph_type graph;
+    graph.reserve(options.nodes + options.updates + 1, options.edges + options.updates * options.batch);
+    for (std::size_t value = 0; value < options.nodes; ++value)
+        graph.insert(static_cast<int>(value));
+    graph.insert(marker(options, 0));
+    for (std::size_t e = 0; e < options.edges; ++e)
+    {
+        const auto [from, to] = nth_edge(e, options.nodes);
+        graph.insert_edge(from, to);
+    }
+    return graph;
+}
+
+[[noreturn]] void fail(const std::string &message, std::size_t threads)
+{
+    std::cerr << "rcu_graph: " << message << " with " << threads << " readers\n";
+    std::exit(1);
+}
+
+// Runs the readers against the writer once, returns the reads and snapshots taken and the seconds the
+// writer needed for all updates.
+std::tuple<std::size_t, std::size_t, double> run_readers(const read_options &options, const graph_type &initial, std::size_t threads)
+{
+    rcu_graph<graph_type> graph(initial, threads);
+    std::atomic<std::size_t> reads{0};
+    std::atomic<std::size_t> snapshots{0};
+    std::atomic<bool> failed{false};
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (std::size_t thread = 0; thread < threads; ++thread)
+    {
+        readers.emplace_back([&, thread]
+                             {
+            auto reader = graph.make_reader();
+            std::mt19937_64 rng(thread + 1);
+            std::uniform_int_distribution<int> node(0, static_cast<int>(options.nodes) - 1);
+            std::uint64_t last_version = 0;
+            std::shared_ptr<const graph_type> held;
+            std::size_t done = 0;
+            std::size_t taken = 0;
+            std::size_t degrees = 0;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                {
+                    const auto guard = reader.read();
+                    const std::uint64_t version = guard.version();
+                    if (version < last_version || !guard->contains(marker(options, version)) || guard->contains(marker(options, version + 1)))
+                        failed.store(true);
+                    last_version = version;
+                    const auto neighbors = guard->neighbors(node(rng));
+                    degrees += static_cast<std::size_t>(std::distance(std::begin(neighbors), std::end(neighbors)));
+                }
+                if (++done % snapshot_interval == 0)
+                {
+                    // keeping the previous snapshot until now holds back its version
+                    held = reader.snapshot();
+                    if (!held->contains(marker(options, last_version)))
+                        failed.store(true);
+                    ++taken;
+                }
+            }
+            do_not_optimize(degrees);
+            reads.fetch_add(done);
+            snapshots.fetch_add(taken); });
+    }
+    while (ready.load() != threads)
+        std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t update = 0; update < options.updates; ++update)
+    {
+        graph.update([&options, update](graph_type &next)
+                     {
+            const std::size_t first = options.edges + update * options.batch;
+            for (std::size_t e = first; e < first + options.batch; ++e)
+            {
+                const auto [from, to] = nth_edge(e, options.nodes);
+                next.insert_edge(from, to);
+            }
+            next.insert(marker(options, update + 1)); });
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stop.store(true);
+    for (auto &&reader : readers)
+        reader.join();
+
+    if (failed.load())
+        fail("a read saw a torn or older version", threads);
+    if (graph.version() != options.updates)
+        fail("the version does not count the updates", threads);
+    graph.reclaim();
+    if (graph.retired_count() != 0)
+        fail(std::to_string(graph.retired_count()) + " versions still retired after reclaim()", threads);
+    return {reads.load(), snapshots.load(), seconds};
+}
+
+read_result measure(const read_options &options, const graph_type &initial, std::size_t threads)
+{
+    read_result result{threads, 0, 0, 0, 0, 0};
+    for (int run = 0; run < options.repeat; ++run)
+    {
+        const auto [reads, snapshots, seconds] = run_readers(options, initial, threads);
+        const double reads_per_sec = seconds > 0 ? reads / seconds : 0;
+        if (run == 0 || reads_per_sec > result.reads_per_sec)
+            result = {threads, reads, snapshots, seconds, reads_per_sec, reads_per_sec / threads};
+    }
+    std::cout << std::right << std::setw(9) << result.threads << std::setw(14) << result.reads << std::setw(12)
+              << result.snapshots << std::setw(12) << std::fixed << std::setprecision(4) << result.seconds << std::setw(16)
+              << std::setprecision(0) << result.reads_per_sec << std::setw(18) << result.reads_per_sec_per_thread << std::endl;
+    return result;
+}
+
+void write_json(const std::vector<read_result> &results, std::ostream &out)
+{
+    out << "{\n  \"benchmark\": \"rcu_graph\",\n  \"results\": [";
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        const auto &result = results[index];
+        out << (index == 0 ? "\n" : ",\n") << "    {\"threads\": " << result.threads << ", \"reads\": " << result.reads
+            << ", \"snapshots\": " << result.snapshots << std::setprecision(6) << std::defaultfloat << ", \"seconds\": "
+            << result.seconds << ", \"reads_per_sec\": " << result.reads_per_sec << ", \"reads_per_sec_per_thread\": "
+            << result.reads_per_sec_per_thread << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int usage(const char *program)
+{
+    std::cerr << "usage: " << program
+              << " [--nodes N] [--edges E] [--updates U] [--batch B] [--max-threads T] [--repeat R] [--json FILE]\n";
+    return 2;
+}
+
+// Driver code
+int main(int argc, char *argv[])
+{
+    read_options options;
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string_view arg = argv[index];
+        if (index + 1 >= argc)
+            return usage(argv[0]);
+        const char *value = argv[++index];
+        if (arg == "--nodes")
+            options.nodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--edges")
+            options.edges = std::strtoull(value, nullptr, 10);
+        else if (arg == "--updates")
+            options.updates = std::strtoull(value, nullptr, 10);
+        else if (arg == "--batch")
+            options.batch = std::strtoull(value, nullptr, 10);
+        else if (arg == "--max-threads")
+            options.max_threads = std::strtoull(value, nullptr, 10);
+        else if (arg == "--repeat")
+            options.repeat = std::atoi(value);
+        else if (arg == "--json")
+            options.json_path = value;
+        else
+            return usage(argv[0]);
+    }
+    // the edges must stay distinct and the markers must fit in an int
+    if (options.nodes < 2 || options.repeat < 1 || options.updates == 0 ||
+        options.edges + options.updates * options.batch > options.nodes * (options.nodes - 1) ||
+        options.nodes + options.updates > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+        return usage(argv[0]);
+
+    const auto initial = make_initial(options);
+    std::cout << std::right << std::setw(9) << "threads" << std::setw(14) << "reads" << std::setw(12) << "snapshots"
+              << std::setw(12) << "seconds" << std::setw(16) << "reads/s" << std::setw(18) << "reads/s/thread" << std::endl;
+
+    std::vector<read_result> results;
+    for (std::size_t threads = 1; threads <= std::min<std::size_t>(options.max_threads, 64); threads *= 2)
+        results.push_back(measure(options, initial, threads));
+
+    if (!options.json_path.empty())
+    {
+        std::ofstream json(options.json_path);
+        write_json(results, json);
+        if (!json)
+        {
+            std::cerr << "cannot write " << options.json_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
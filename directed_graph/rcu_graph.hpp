@@ -0,0 +1,286 @@
+#ifndef RCU_GRAPH_HPP
+#define RCU_GRAPH_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Single-writer / multi-reader wrapper around a graph, read-copy-update style.
+//
+// Readers see immutable versions of the graph. Every reader thread claims a reader once
+// (make_reader()), after which read() is wait-free: it publishes the current epoch in the
+// reader's own cache line and loads the current version, readers never write shared state.
+// snapshot() turns the current version into a reference-counted std::shared_ptr<const Graph>
+// that can outlive the read section.
+//
+// The writer applies a batch of changes to a private copy of the current version and publishes
+// it with one pointer swap, so readers are never blocked by writes. Replaced versions are
+// reclaimed by epoch: a version retired in epoch R is freed once no reader is still inside
+// a read section that started in an epoch <= R. Each update copies the graph, so batch writes.
+template <typename Graph>
+class rcu_graph
+{
+    struct graph_version
+    {
+        std::shared_ptr<const Graph> m_graph;
+        std::uint64_t m_number;
+    };
+
+    // One per reader, on its own cache line so readers do not contend.
+    struct alignas(64) reader_slot
+    {
+        std::atomic<std::uint64_t> m_epoch{0}; // 0 while the reader is outside a read section
+        std::atomic<bool> m_inUse{false};
+        // Only touched by the thread owning the slot. The guards count here rather than in the
+        // reader, so they stay valid if the reader is moved or destroyed before them.
+        std::size_t m_depth = 0;
+        bool m_released = false; // the reader is gone, the last guard frees the slot
+    };
+
+    struct retired_version
+    {
+        graph_version *m_version;
+        std::uint64_t m_epoch;
+    };
+
+public:
+    using graph_type = Graph;
+    static constexpr std::size_t default_max_readers = 64;
+
+    class reader;
+
+    // Pins the version that was current when it was created, see reader::read().
+    class read_guard
+    {
+    public:
+        read_guard(const read_guard &) = delete;
+        read_guard &operator=(const read_guard &) = delete;
+        ~read_guard();
+
+        const Graph &operator*() const noexcept { return *m_version->m_graph; }
+        const Graph *operator->() const noexcept { return m_version->m_graph.get(); }
+        // Number of the pinned version, increases by one with every update.
+        std::uint64_t version() const noexcept { return m_version->m_number; }
+        // Shared ownership of the pinned version, valid after the guard is gone.
+        std::shared_ptr<const Graph> snapshot() const { return m_version->m_graph; }
+
+    private:
+        friend class reader;
+        read_guard(const rcu_graph &graph, reader_slot &slot);
+
+        reader_slot *m_slot;
+        const graph_version *m_version;
+    };
+
+    // A claimed reader slot, meant to be used by one thread at a time. Read sections may nest,
+    // and a read_guard may outlive the reader it came from.
+    class reader
+    {
+    public:
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+        reader(reader &&other) noexcept;
+        ~reader();
+
+        read_guard read() { return read_guard(*m_graph, *m_slot); }
+        std::shared_ptr<const Graph> snapshot() { return read().snapshot(); }
+
+    private:
+        friend class rcu_graph;
+        friend class read_guard;
+        reader(const rcu_graph &graph, reader_slot &slot) noexcept : m_graph(&graph), m_slot(&slot) {}
+
+        const rcu_graph *m_graph;
+        reader_slot *m_slot;
+    };
+
+    explicit rcu_graph(Graph initial = Graph(), std::size_t max_readers = default_max_readers);
+    rcu_graph(const rcu_graph &) = delete;
+    rcu_graph &operator=(const rcu_graph &) = delete;
+    // All readers must be gone.
+    ~rcu_graph();
+
+    // Claims a reader slot. Throws std::length_error if all max_readers slots are taken.
+    reader make_reader() const;
+
+    // Calls batch(graph) on a copy of the current version and publishes the result.
+    // If batch throws nothing is published. Writers are serialized, readers are never blocked.
+    // Returns the number of the published version.
+    template <typename Batch>
+    std::uint64_t update(Batch &&batch);
+
+    // Number of the current version, 0 for the initial graph.
+    std::uint64_t version() const noexcept;
+
+    // Frees the retired versions no reader can still see, returns how many were freed.
+    // update() does this after publishing, call it to reclaim sooner once readers have left.
+    std::size_t reclaim();
+    // Number of replaced versions waiting for readers to leave.
+    std::size_t retired_count() const;
+
+private:
+    std::atomic<graph_version *> m_current;
+    std::atomic<std::uint64_t> m_epoch{1};
+    std::unique_ptr<reader_slot[]> m_slots;
+    std::size_t m_slotCount;
+
+    mutable std::mutex m_writerMutex;
+    std::vector<retired_version> m_retired; // guarded by m_writerMutex
+
+    std::size_t reclaim_locked();
+};
+
+template <typename Graph>
+rcu_graph<Graph>::read_guard::read_guard(const rcu_graph &graph, reader_slot &slot) : m_slot(&slot)
+{
+    if (m_slot->m_depth++ == 0)
+    {
+        // The epoch has to be visible before the version is loaded, see reclaim_locked().
+        const std::uint64_t epoch = graph.m_epoch.load(std::memory_order_seq_cst);
+        m_slot->m_epoch.store(epoch, std::memory_order_seq_cst);
+    }
+    m_version = graph.m_current.load(std::memory_order_seq_cst);
+}
+
+template <typename Graph>
+rcu_graph<Graph>::read_guard::~read_guard()
+{
+    if (--m_slot->m_depth != 0)
+        return;
+    m_slot->m_epoch.store(0, std::memory_order_release);
+    if (m_slot->m_released)
+    {
+        m_slot->m_released = false;
+        m_slot->m_inUse.store(false, std::memory_order_release);
+    }
+}
+
+template <typename Graph>
+rcu_graph<Graph>::reader::reader(reader &&other) noexcept : m_graph(other.m_graph), m_slot(std::exchange(other.m_slot, nullptr)) {}
+
+template <typename Graph>
+rcu_graph<Graph>::reader::~reader()
+{
+    if (m_slot == nullptr)
+        return;
+    if (m_slot->m_depth != 0)
+    {
+        // guards are still reading, the version they pinned stays protected until the last one ends
+        m_slot->m_released = true;
+        return;
+    }
+    m_slot->m_epoch.store(0, std::memory_order_release);
+    m_slot->m_inUse.store(false, std::memory_order_release);
+}
+
+template <typename Graph>
+rcu_graph<Graph>::rcu_graph(Graph initial, std::size_t max_readers)
+    : m_current(new graph_version{std::make_shared<const Graph>(std::move(initial)), 0}), m_slots(new reader_slot[max_readers]), m_slotCount(max_readers)
+{
+}
+
+template <typename Graph>
+rcu_graph<Graph>::~rcu_graph()
+{
+    for (auto &&retired : m_retired)
+        delete retired.m_version;
+    delete m_current.load(std::memory_order_relaxed);
+}
+
+template <typename Graph>
+typename rcu_graph<Graph>::reader rcu_graph<Graph>::make_reader() const
+{
+    for (std::size_t index = 0; index < m_slotCount; ++index)
+    {
+        bool expected = false;
+        if (m_slots[index].m_inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return reader(*this, m_slots[index]);
+    }
+    throw std::length_error("rcu_graph: all reader slots are taken");
+}
+
+template <typename Graph>
+template <typename Batch>
+std::uint64_t rcu_graph<Graph>::update(Batch &&batch)
+{
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+    graph_version *old_version = m_current.load(std::memory_order_relaxed); // only writers store it
+
+    auto next = std::make_shared<Graph>(*old_version->m_graph);
+    std::forward<Batch>(batch)(*next);
+    const std::uint64_t number = old_version->m_number + 1;
+    auto *new_version = new graph_version{std::move(next), number};
+
+    m_current.store(new_version, std::memory_order_seq_cst);
+    // Readers that could still load old_version read an epoch <= retired_epoch before loading it.
+    const std::uint64_t retired_epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+    try
+    {
+        m_retired.push_back({old_version, retired_epoch});
+    }
+    catch (...)
+    {
+        // cannot track it, leak rather than free a version a reader may hold
+    }
+    reclaim_locked();
+    return number;
+}
+
+template <typename Graph>
+std::uint64_t rcu_graph<Graph>::version() const noexcept
+{
+    return m_current.load(std::memory_order_acquire)->m_number;
+}
+
+template <typename Graph>
+std::size_t rcu_graph<Graph>::reclaim()
+{
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+    return reclaim_locked();
+}
+
+template <typename Graph>
+std::size_t rcu_graph<Graph>::retired_count() const
+{
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+    return m_retired.size();
+}
+
+template <typename Graph>
+std::size_t rcu_graph<Graph>::reclaim_locked()
+{
+    if (m_retired.empty())
+        return 0;
+
+    // A reader that published epoch e before the scan loaded a version current at epoch e or later.
+    // A reader that publishes after the scan loads a version that is already current, never a retired one.
+    std::uint64_t oldest_active = UINT64_MAX;
+    for (std::size_t index = 0; index < m_slotCount; ++index)
+    {
+        const std::uint64_t epoch = m_slots[index].m_epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < oldest_active)
+            oldest_active = epoch;
+    }
+
+    std::size_t freed = 0;
+    auto kept = std::begin(m_retired);
+    for (auto &&retired : m_retired)
+    {
+        if (retired.m_epoch < oldest_active)
+        {
+            delete retired.m_version;
+            ++freed;
+        }
+        else
+        {
+            *kept++ = retired;
+        }
+    }
+    m_retired.erase(kept, std::end(m_retired));
+    return freed;
+}
+#endif
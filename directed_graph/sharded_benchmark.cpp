@@ -0,0 +1,221 @@
+// Stress benchmark for sharded_graph.
+//
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread sharded_benchmark.cpp -o sharded_benchmark
+//   ./sharded_benchmark [--nodes N] [--edges E] [--max-threads T] [--shards S] [--repeat R] [--json FILE]
+//
+// For 1, 2, 4, ... up to --max-threads threads (at most 64), every thread inserts its own share of
+// the nodes and then its share of E random edges, erasing every fourth edge it inserted. The same
+// work is run on a directed_graph behind a single mutex as the baseline. Every run is checked by
+// freezing the sharded graph and comparing its edge count with the one the threads reported.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "directed_graph.hpp"
+#include "sharded_graph.hpp"
+
+struct stress_options
+{
+    std::size_t nodes = 100000;
+    std::size_t edges = 1000000; // split between the threads
+    std::size_t max_threads = 64;
+    std::size_t shards = sharded_graph<int>::default_shard_count;
+    int repeat = 3;
+    std::string json_path;
+};
+
+struct stress_result
+{
+    std::string graph;
+    std::size_t threads;
+    std::size_t ops;
+    double seconds;
+    double ops_per_sec;
+};
+
+// The graph under test behind one interface: sharded_graph, or directed_graph with a global lock.
+struct locked_graph
+{
+    std::mutex m_mutex;
+    directed_graph<int> m_graph;
+
+    bool insert(int value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_graph.insert(value).second;
+    }
+    bool insert_edge(int from, int to)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_graph.insert_edge(from, to);
+    }
+    bool erase_edge(int from, int to)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_graph.erase_edge(from, to);
+    }
+};
+
+// Runs the workload on threads threads, returns the operations done and the edges left behind.
+template <typename Graph>
+std::pair<std::size_t, std::size_t> run_workload(Graph &graph, const stress_options &options, std::size_t threads)
+{
+    std::atomic<std::size_t> edges_left{0};
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    const std::size_t edges_per_thread = std::max<std::size_t>(options.edges / threads, 1);
+    for (std::size_t thread = 0; thread < threads; ++thread)
+    {
+        workers.emplace_back([&, thread]
+                             {
+            std::mt19937_64 rng(thread + 1);
+            std::uniform_int_distribution<int> node(0, static_cast<int>(options.nodes) - 1);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            for (std::size_t value = thread; value < options.nodes; value += threads)
+                graph.insert(static_cast<int>(value));
+            // edges to nodes other threads have not inserted yet fail, like they would in an ingest
+            std::size_t kept = 0;
+            for (std::size_t index = 0; index < edges_per_thread; ++index)
+            {
+                const int from = node(rng);
+                const int to = node(rng);
+                if (graph.insert_edge(from, to))
+                {
+                    if (index % 4 == 0 && graph.erase_edge(from, to))
+                        continue;
+                    ++kept;
+                }
+            }
+            edges_left.fetch_add(kept); });
+    }
+    while (ready.load() != threads)
+        std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    for (auto &&worker : workers)
+        worker.join();
+    return {options.nodes + edges_per_thread * threads, edges_left.load()};
+}
+
+template <typename Graph, typename Make, typename Check>
+stress_result measure(const std::string &name, const stress_options &options, std::size_t threads, Make make, Check check)
+{
+    double best = 0;
+    std::size_t ops = 0;
+    for (int run = 0; run < options.repeat; ++run)
+    {
+        auto graph = make();
+        const auto start = std::chrono::steady_clock::now();
+        const auto [done, edges_left] = run_workload(*graph, options, threads);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!check(*graph, edges_left))
+        {
+            std::cerr << name << ": edge count mismatch with " << threads << " threads\n";
+            std::exit(1);
+        }
+        ops = done;
+        if (run == 0 || seconds < best)
+            best = seconds;
+    }
+    const stress_result result{name, threads, ops, best, best > 0 ? ops / best : 0};
+    std::cout << std::left << std::setw(10) << result.graph << std::right << std::setw(9) << result.threads << std::setw(12)
+              << result.ops << std::setw(14) << std::fixed << std::setprecision(4) << result.seconds << std::setw(16)
+              << std::setprecision(0) << result.ops_per_sec << std::endl;
+    return result;
+}
+
+void write_json(const std::vector<stress_result> &results, std::ostream &out)
+{
+    out << "{\n  \"benchmark\": \"sharded_graph\",\n  \"results\": [";
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        const auto &result = results[index];
+        out << (index == 0 ? "\n" : ",\n") << "    {\"graph\": \"" << result.graph << "\", \"threads\": " << result.threads
+            << ", \"ops\": " << result.ops << std::setprecision(6) << std::defaultfloat << ", \"seconds\": " << result.seconds
+            << ", \"ops_per_sec\": " << result.ops_per_sec << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int usage(const char *program)
+{
+    std::cerr << "usage: " << program
+              << " [--nodes N] [--edges E] [--max-threads T] [--shards S] [--repeat R] [--json FILE]\n";
+    return 2;
+}
+
+// Driver code
+int main(int argc, char *argv[])
+{
+    stress_options options;
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string_view arg = argv[index];
+        if (index + 1 >= argc)
+            return usage(argv[0]);
+        const char *value = argv[++index];
+        if (arg == "--nodes")
+            options.nodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--edges")
+            options.edges = std::strtoull(value, nullptr, 10);
+        else if (arg == "--max-threads")
+            options.max_threads = std::strtoull(value, nullptr, 10);
+        else if (arg == "--shards")
+            options.shards = std::strtoull(value, nullptr, 10);
+        else if (arg == "--repeat")
+            options.repeat = std::atoi(value);
+        else if (arg == "--json")
+            options.json_path = value;
+        else
+            return usage(argv[0]);
+    }
+    if (options.nodes == 0 || options.repeat < 1)
+        return usage(argv[0]);
+
+    std::cout << std::left << std::setw(10) << "graph" << std::right << std::setw(9) << "threads" << std::setw(12) << "ops"
+              << std::setw(14) << "seconds" << std::setw(16) << "ops/s" << std::endl;
+
+    std::vector<stress_result> results;
+    for (std::size_t threads = 1; threads <= std::min<std::size_t>(options.max_threads, 64); threads *= 2)
+    {
+        results.push_back(measure<sharded_graph<int>>(
+            "sharded", options, threads, [&]
+            { return std::make_unique<sharded_graph<int>>(options.shards); },
+            [](const sharded_graph<int> &graph, std::size_t edges_left)
+            {
+                const auto frozen = graph.freeze();
+                return frozen.edge_count() == edges_left && graph.edge_count() == edges_left;
+            }));
+        results.push_back(measure<locked_graph>(
+            "locked", options, threads, []
+            { return std::make_unique<locked_graph>(); },
+            [](const locked_graph &graph, std::size_t edges_left)
+            { return graph.m_graph.edge_count() == edges_left; }));
+    }
+
+    if (!options.json_path.empty())
+    {
+        std::ofstream json(options.json_path);
+        write_json(results, json);
+        if (!json)
+        {
+            std::cerr << "cannot write " << options.json_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+#ifndef SHARDED_GRAPH_HPP
+#define SHARDED_GRAPH_HPP
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "graph_node.hpp"
+#include "small_flat_set.hpp"
+#include "node_index.hpp"
+#include "directed_graph.hpp"
+
+// Directed graph for concurrent mutation. Nodes are sharded by the hash of their value and
+// every shard has its own lock, so threads working on different shards never contend.
+// insert, insert_edge, erase_edge, contains and has_edge are linearizable; every operation
+// holds at most one shard lock at a time. Nodes cannot be erased, which keeps node ids stable
+// across shards: an id packs the shard number and the index of the node within its shard.
+// Once mutation is done, freeze() turns the graph into a regular directed_graph for reading.
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+class sharded_graph
+{
+    static_assert(!std::is_void_v<Hash>, "sharded_graph needs a hash to pick shards");
+
+public:
+    using value_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using size_type = std::size_t;
+    using node_id = std::uint64_t;
+    using frozen_graph_type = directed_graph<T, Hash, KeyEqual>;
+
+    static constexpr size_type default_shard_count = 64;
+
+    // shard_count is rounded up to a power of two.
+    explicit sharded_graph(size_type shard_count = default_shard_count);
+    sharded_graph(const sharded_graph &) = delete;
+    sharded_graph &operator=(const sharded_graph &) = delete;
+
+    // Returns false if the value was already in the graph.
+    bool insert(const T &node_value);
+    // Return false if either node is missing, or if the edge already / did not exist.
+    bool insert_edge(const T &from_node_value, const T &to_node_value);
+    bool erase_edge(const T &from_node_value, const T &to_node_value);
+
+    bool contains(const T &node_value) const;
+    bool has_edge(const T &from_node_value, const T &to_node_value) const;
+
+    // Shards are visited one after the other, so while other threads mutate
+    // the counts are only a lower bound of the final ones.
+    size_type size() const;
+    size_type edge_count() const;
+    size_type shard_count() const noexcept;
+
+    // Copies the graph into a directed_graph while holding every shard lock, i.e. a
+    // consistent snapshot. Nodes are ordered by shard, then by insertion within a shard.
+    frozen_graph_type freeze() const;
+
+private:
+    using node_type = graph_node<T, small_flat_set<node_id>>;
+    static constexpr unsigned local_bits = 48;
+
+    struct alignas(64) shard
+    {
+        mutable std::mutex m_mutex;
+        node_index<T, Hash, KeyEqual> m_index;
+        std::vector<node_type> m_nodes;
+
+        // what m_index compares lookups with
+        auto value_at() const noexcept
+        {
+            return [this](std::size_t index) -> const T & { return m_nodes[index].get(); };
+        }
+    };
+
+    std::unique_ptr<shard[]> m_shards;
+    size_type m_shardCount;
+    unsigned m_shardBits;
+
+    shard &shard_of(const T &node_value) const noexcept;
+    size_type shard_number(const T &node_value) const noexcept;
+    // Id of the node with the given value, or no_node. Takes the lock of its shard.
+    node_id find_id(const T &node_value) const;
+
+    static constexpr node_id no_node = static_cast<node_id>(-1);
+    static node_id make_id(size_type shard, size_type local) noexcept { return (static_cast<node_id>(shard) << local_bits) | local; }
+    static size_type shard_of_id(node_id id) noexcept { return static_cast<size_type>(id >> local_bits); }
+    static size_type local_of_id(node_id id) noexcept { return static_cast<size_type>(id & ((node_id{1} << local_bits) - 1)); }
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+sharded_graph<T, Hash, KeyEqual>::sharded_graph(size_type shard_count)
+    : m_shardCount(std::bit_ceil(shard_count == 0 ? size_type{1} : shard_count)), m_shardBits(std::countr_zero(m_shardCount))
+{
+    m_shards = std::make_unique<shard[]>(m_shardCount);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::size_type sharded_graph<T, Hash, KeyEqual>::shard_number(const T &node_value) const noexcept
+{
+    if (m_shardBits == 0)
+        return 0;
+    // std::hash is the identity for integers, mix before taking the top bits
+    const std::uint64_t hash = static_cast<std::uint64_t>(Hash{}(node_value)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_type>(hash >> (64 - m_shardBits));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::shard &sharded_graph<T, Hash, KeyEqual>::shard_of(const T &node_value) const noexcept
+{
+    return m_shards[shard_number(node_value)];
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::node_id sharded_graph<T, Hash, KeyEqual>::find_id(const T &node_value) const
+{
+    const size_type number = shard_number(node_value);
+    const shard &target = m_shards[number];
+    std::lock_guard<std::mutex> lock(target.m_mutex);
+    const std::size_t found = target.m_index.find(node_value, target.value_at());
+    if (found == target.m_index.npos)
+        return no_node;
+    return make_id(number, found);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool sharded_graph<T, Hash, KeyEqual>::insert(const T &node_value)
+{
+    shard &target = shard_of(node_value);
+    std::lock_guard<std::mutex> lock(target.m_mutex);
+    if (target.m_index.find(node_value, target.value_at()) != target.m_index.npos)
+        return false;
+    target.m_nodes.emplace_back(node_value);
+    try
+    {
+        target.m_index.insert_absent(node_value, target.m_nodes.size() - 1);
+    }
+    catch (...)
+    {
+        target.m_nodes.pop_back(); // keep the nodes and the index consistent
+        throw;
+    }
+    return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool sharded_graph<T, Hash, KeyEqual>::insert_edge(const T &from_node_value, const T &to_node_value)
+{
+    // Nodes are never erased, so once resolved the id of the target stays valid
+    // and the edge takes effect under the lock of the source shard alone.
+    const node_id to = find_id(to_node_value);
+    if (to == no_node)
+        return false;
+
+    shard &source = shard_of(from_node_value);
+    std::lock_guard<std::mutex> lock(source.m_mutex);
+    const std::size_t from = source.m_index.find(from_node_value, source.value_at());
+    if (from == source.m_index.npos)
+        return false;
+    return source.m_nodes[from].get_adjacent_node_indices().insert(to).second;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool sharded_graph<T, Hash, KeyEqual>::erase_edge(const T &from_node_value, const T &to_node_value)
+{
+    const node_id to = find_id(to_node_value);
+    if (to == no_node)
+        return false;
+
+    shard &source = shard_of(from_node_value);
+    std::lock_guard<std::mutex> lock(source.m_mutex);
+    const std::size_t from = source.m_index.find(from_node_value, source.value_at());
+    if (from == source.m_index.npos)
+        return false;
+    return source.m_nodes[from].get_adjacent_node_indices().erase(to) != 0;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool sharded_graph<T, Hash, KeyEqual>::contains(const T &node_value) const
+{
+    return find_id(node_value) != no_node;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool sharded_graph<T, Hash, KeyEqual>::has_edge(const T &from_node_value, const T &to_node_value) const
+{
+    const node_id to = find_id(to_node_value);
+    if (to == no_node)
+        return false;
+
+    const shard &source = shard_of(from_node_value);
+    std::lock_guard<std::mutex> lock(source.m_mutex);
+    const std::size_t from = source.m_index.find(from_node_value, source.value_at());
+    return from != source.m_index.npos && source.m_nodes[from].get_adjacent_node_indices().contains(to);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::size_type sharded_graph<T, Hash, KeyEqual>::size() const
+{
+    size_type count = 0;
+    for (size_type number = 0; number < m_shardCount; ++number)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[number].m_mutex);
+        count += m_shards[number].m_nodes.size();
+    }
+    return count;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::size_type sharded_graph<T, Hash, KeyEqual>::edge_count() const
+{
+    size_type count = 0;
+    for (size_type number = 0; number < m_shardCount; ++number)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[number].m_mutex);
+        for (auto &&node : m_shards[number].m_nodes)
+            count += node.get_adjacent_node_indices().size();
+    }
+    return count;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::size_type sharded_graph<T, Hash, KeyEqual>::shard_count() const noexcept
+{
+    return m_shardCount;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename sharded_graph<T, Hash, KeyEqual>::frozen_graph_type sharded_graph<T, Hash, KeyEqual>::freeze() const
+{
+    // Other operations hold one lock at a time, so taking all of them in shard order cannot deadlock.
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(m_shardCount);
+    for (size_type number = 0; number < m_shardCount; ++number)
+        locks.emplace_back(m_shards[number].m_mutex);
+
+    // Node i of shard s becomes node offsets[s] + i, which preserves the order of the
+    // packed ids, so every sorted adjacency list stays sorted after remapping.
+    std::vector<size_type> offsets(m_shardCount + 1, 0);
+    for (size_type number = 0; number < m_shardCount; ++number)
+        offsets[number + 1] = offsets[number] + m_shards[number].m_nodes.size();
+
+    frozen_graph_type graph;
+    for (size_type number = 0; number < m_shardCount; ++number)
+    {
+        for (auto &&node : m_shards[number].m_nodes)
+            graph.insert(node.get());
+    }
+
+    std::vector<size_type> targets;
+    for (size_type number = 0; number < m_shardCount; ++number)
+    {
+        const auto &nodes = m_shards[number].m_nodes;
+        for (size_type local = 0; local < nodes.size(); ++local)
+        {
+            targets.clear();
+            for (auto &&id : nodes[local].get_adjacent_node_indices())
+                targets.push_back(offsets[shard_of_id(id)] + local_of_id(id));
+            auto &indices = graph.m_nodes[offsets[number] + local].get_adjacent_node_indices();
+            if constexpr (requires { indices.assign_sorted_unique(std::cbegin(targets), std::cend(targets)); })
+            {
+                indices.assign_sorted_unique(std::cbegin(targets), std::cend(targets));
+            }
+            else
+            {
+                for (auto &&target : targets)
+                    indices.insert(std::end(indices), target);
+            }
+        }
+    }
+    return graph;
+}
+#endif
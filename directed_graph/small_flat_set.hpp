@@ -0,0 +1,493 @@
+#ifndef SMALL_FLAT_SET_HPP
+#define SMALL_FLAT_SET_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+// Sorted set of trivially copyable keys stored in one contiguous array.
+// Up to N keys live in an inline buffer, so small sets never allocate;
+// larger sets spill to a heap buffer obtained from Allocator that grows like a vector.
+// Unlike std::set, inserting or erasing invalidates iterators into the set.
+template <typename Key, std::size_t N = 8, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class small_flat_set
+{
+    static_assert(std::is_trivially_copyable_v<Key>, "small_flat_set only stores trivially copyable keys");
+    static_assert(N > 0, "small_flat_set needs an inline buffer");
+
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using reference = const value_type &;
+    using const_reference = const value_type &;
+    using pointer = const value_type *;
+    using const_pointer = const value_type *;
+    // keys are immutable through iterators, just like std::set
+    using iterator = const value_type *;
+    using const_iterator = const value_type *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inline_capacity = N;
+
+    small_flat_set() noexcept(std::is_nothrow_default_constructible_v<Allocator>) = default;
+    explicit small_flat_set(const Allocator &alloc) noexcept;
+    small_flat_set(std::initializer_list<Key> init, const Allocator &alloc = Allocator());
+    small_flat_set(const small_flat_set &other);
+    small_flat_set(const small_flat_set &other, const Allocator &alloc);
+    small_flat_set(small_flat_set &&other) noexcept;
+    small_flat_set(small_flat_set &&other, const Allocator &alloc);
+    ~small_flat_set();
+
+    small_flat_set &operator=(const small_flat_set &rhs);
+    small_flat_set &operator=(small_flat_set &&rhs) noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                                                             std::allocator_traits<Allocator>::is_always_equal::value);
+
+    allocator_type get_allocator() const noexcept { return m_allocator; }
+
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + m_size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    const value_type *data() const noexcept { return is_inline() ? m_storage.m_inline : m_storage.m_heap; }
+    size_type size() const noexcept { return m_size; }
+    size_type capacity() const noexcept { return m_capacity; }
+    bool empty() const noexcept { return m_size == 0; }
+    size_type max_size() const noexcept;
+
+    std::pair<iterator, bool> insert(const value_type &key);
+    // The hint is ignored; the position is found by binary search.
+    iterator insert(const_iterator hint, const value_type &key);
+    template <typename Iter>
+    void insert(Iter first, Iter last);
+
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const key_type &key);
+
+    const_iterator find(const key_type &key) const;
+    const_iterator lower_bound(const key_type &key) const;
+    size_type count(const key_type &key) const;
+    bool contains(const key_type &key) const;
+
+    void clear() noexcept;
+    void reserve(size_type new_capacity);
+    // Moves the keys back into the inline buffer when they fit.
+    void shrink_to_fit();
+
+    // Merges a sorted, duplicate-free range of keys (as extracted by proj) into the set in O(size + count),
+    // returns the number of keys that were not in the set yet. Iter must be bidirectional.
+    template <typename Iter, typename Projection = std::identity>
+    size_type merge_sorted_unique(Iter first, Iter last, Projection proj = {});
+
+    // Replaces the contents with keys that are already sorted and unique, e.g. from a bulk build.
+    template <typename Iter>
+    void assign_sorted_unique(Iter first, Iter last);
+
+    // Removes removed_key and renumbers every key above it down by one, in place.
+    // Only available for integral keys, where it keeps the set sorted.
+    void remove_and_renumber(const key_type &removed_key);
+
+    void swap(small_flat_set &other) noexcept;
+
+    bool operator==(const small_flat_set &rhs) const;
+    bool operator!=(const small_flat_set &rhs) const;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    bool is_inline() const noexcept { return m_capacity == N; }
+    value_type *mutable_data() noexcept { return is_inline() ? m_storage.m_inline : m_storage.m_heap; }
+    void grow_to(size_type new_capacity);
+    void release() noexcept;
+    void copy_from(const small_flat_set &other);
+    void steal_from(small_flat_set &other) noexcept;
+
+    union storage
+    {
+        value_type m_inline[N];
+        value_type *m_heap;
+    };
+
+    storage m_storage{};
+    size_type m_size = 0;
+    size_type m_capacity = N;
+    [[no_unique_address]] Allocator m_allocator{};
+};
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(const Allocator &alloc) noexcept : m_allocator(alloc) {}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(std::initializer_list<Key> init, const Allocator &alloc) : m_allocator(alloc)
+{
+    insert(std::begin(init), std::end(init));
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(const small_flat_set &other)
+    : m_allocator(alloc_traits::select_on_container_copy_construction(other.m_allocator))
+{
+    copy_from(other);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(const small_flat_set &other, const Allocator &alloc) : m_allocator(alloc)
+{
+    copy_from(other);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(small_flat_set &&other) noexcept : m_allocator(std::move(other.m_allocator))
+{
+    steal_from(other);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::small_flat_set(small_flat_set &&other, const Allocator &alloc) : m_allocator(alloc)
+{
+    if (m_allocator == other.m_allocator)
+        steal_from(other);
+    else
+        copy_from(other);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator>::~small_flat_set()
+{
+    release();
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator> &small_flat_set<Key, N, Compare, Allocator>::operator=(const small_flat_set &rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+    {
+        if (m_allocator != rhs.m_allocator)
+            release();
+        m_allocator = rhs.m_allocator;
+    }
+    m_size = 0;
+    copy_from(rhs);
+    return *this;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+small_flat_set<Key, N, Compare, Allocator> &small_flat_set<Key, N, Compare, Allocator>::operator=(small_flat_set &&rhs) noexcept(
+    std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+    std::allocator_traits<Allocator>::is_always_equal::value)
+{
+    if (this == &rhs)
+        return *this;
+
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+    {
+        release();
+        m_allocator = std::move(rhs.m_allocator);
+        steal_from(rhs);
+    }
+    else
+    {
+        if (m_allocator == rhs.m_allocator)
+        {
+            release();
+            steal_from(rhs);
+        }
+        else
+        {
+            m_size = 0;
+            copy_from(rhs); // allocators differ, the heap buffer cannot change hands
+        }
+    }
+    return *this;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::size_type small_flat_set<Key, N, Compare, Allocator>::max_size() const noexcept
+{
+    return alloc_traits::max_size(m_allocator);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+std::pair<typename small_flat_set<Key, N, Compare, Allocator>::iterator, bool> small_flat_set<Key, N, Compare, Allocator>::insert(const value_type &key)
+{
+    auto pos = lower_bound(key);
+    size_type offset = pos - begin();
+    if (pos != end() && !Compare{}(key, *pos))
+        return std::make_pair(pos, false); // key is already in the set
+
+    const value_type copy = key; // key may refer into our own buffer
+    if (m_size == m_capacity)
+        grow_to(m_capacity * 2);
+
+    value_type *first = mutable_data();
+    std::copy_backward(first + offset, first + m_size, first + m_size + 1);
+    first[offset] = copy;
+    ++m_size;
+    return std::make_pair(first + offset, true);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::iterator small_flat_set<Key, N, Compare, Allocator>::insert(const_iterator, const value_type &key)
+{
+    return insert(key).first;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+template <typename Iter>
+void small_flat_set<Key, N, Compare, Allocator>::insert(Iter first, Iter last)
+{
+    for (auto iter = first; iter != last; ++iter)
+        insert(*iter);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::iterator small_flat_set<Key, N, Compare, Allocator>::erase(const_iterator pos)
+{
+    return erase(pos, pos + 1);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::iterator small_flat_set<Key, N, Compare, Allocator>::erase(const_iterator first, const_iterator last)
+{
+    value_type *base = mutable_data();
+    value_type *dest = base + (first - begin());
+    value_type *src = base + (last - begin());
+    std::copy(src, base + m_size, dest);
+    m_size -= static_cast<size_type>(last - first);
+    return dest;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::size_type small_flat_set<Key, N, Compare, Allocator>::erase(const key_type &key)
+{
+    auto pos = find(key);
+    if (pos == end())
+        return 0;
+    erase(pos);
+    return 1;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::const_iterator small_flat_set<Key, N, Compare, Allocator>::find(const key_type &key) const
+{
+    auto pos = lower_bound(key);
+    if (pos != end() && !Compare{}(key, *pos))
+        return pos;
+    return end();
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::const_iterator small_flat_set<Key, N, Compare, Allocator>::lower_bound(const key_type &key) const
+{
+    return std::lower_bound(begin(), end(), key, Compare{});
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+typename small_flat_set<Key, N, Compare, Allocator>::size_type small_flat_set<Key, N, Compare, Allocator>::count(const key_type &key) const
+{
+    return find(key) == end() ? 0 : 1;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+bool small_flat_set<Key, N, Compare, Allocator>::contains(const key_type &key) const
+{
+    return find(key) != end();
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::clear() noexcept
+{
+    m_size = 0;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::reserve(size_type new_capacity)
+{
+    if (new_capacity > m_capacity)
+        grow_to(new_capacity);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::shrink_to_fit()
+{
+    if (is_inline() || m_size == m_capacity)
+        return;
+
+    if (m_size <= N)
+    {
+        value_type *heap = m_storage.m_heap;
+        std::copy(heap, heap + m_size, m_storage.m_inline);
+        alloc_traits::deallocate(m_allocator, heap, m_capacity);
+        m_capacity = N;
+    }
+    else
+    {
+        value_type *heap = alloc_traits::allocate(m_allocator, m_size);
+        std::copy(m_storage.m_heap, m_storage.m_heap + m_size, heap);
+        alloc_traits::deallocate(m_allocator, m_storage.m_heap, m_capacity);
+        m_storage.m_heap = heap;
+        m_capacity = m_size;
+    }
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+template <typename Iter, typename Projection>
+typename small_flat_set<Key, N, Compare, Allocator>::size_type small_flat_set<Key, N, Compare, Allocator>::merge_sorted_unique(Iter first, Iter last, Projection proj)
+{
+    size_type added = 0;
+    auto existing = begin();
+    for (auto iter = first; iter != last; ++iter)
+    {
+        const value_type key = std::invoke(proj, *iter);
+        existing = std::lower_bound(existing, end(), key, Compare{});
+        if (existing == end() || Compare{}(key, *existing))
+            ++added;
+    }
+    if (added == 0)
+        return 0;
+
+    reserve(m_size + added);
+    // merge from the back so every key moves at most once
+    value_type *first_key = mutable_data();
+    value_type *in_existing = first_key + m_size;
+    value_type *out = in_existing + added;
+    for (auto in_new = last; in_new != first;)
+    {
+        const value_type key = std::invoke(proj, *std::prev(in_new));
+        if (in_existing != first_key && Compare{}(key, *(in_existing - 1)))
+        {
+            *--out = *--in_existing;
+        }
+        else
+        {
+            if (in_existing != first_key && !Compare{}(*(in_existing - 1), key))
+                --in_existing; // already in the set
+            *--out = key;
+            --in_new;
+        }
+    }
+    m_size += added;
+    return added;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+template <typename Iter>
+void small_flat_set<Key, N, Compare, Allocator>::assign_sorted_unique(Iter first, Iter last)
+{
+    const auto count = static_cast<size_type>(std::distance(first, last));
+    m_size = 0;
+    reserve(count);
+    std::copy(first, last, mutable_data());
+    m_size = count;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::remove_and_renumber(const key_type &removed_key)
+{
+    static_assert(std::is_integral_v<Key>, "renumbering needs integral keys");
+
+    erase(removed_key);
+    // every key above removed_key shifts down by one, which keeps the keys sorted and unique
+    value_type *first = mutable_data();
+    for (auto iter = first + (lower_bound(removed_key) - begin()); iter != first + m_size; ++iter)
+        --*iter;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::swap(small_flat_set &other) noexcept
+{
+    small_flat_set tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+bool small_flat_set<Key, N, Compare, Allocator>::operator==(const small_flat_set &rhs) const
+{
+    return std::equal(begin(), end(), rhs.begin(), rhs.end());
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+bool small_flat_set<Key, N, Compare, Allocator>::operator!=(const small_flat_set &rhs) const
+{
+    return !(*this == rhs);
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::grow_to(size_type new_capacity)
+{
+    value_type *heap = alloc_traits::allocate(m_allocator, new_capacity);
+    std::copy(begin(), end(), heap);
+    if (!is_inline())
+        alloc_traits::deallocate(m_allocator, m_storage.m_heap, m_capacity);
+    m_storage.m_heap = heap;
+    m_capacity = new_capacity;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::release() noexcept
+{
+    if (!is_inline())
+        alloc_traits::deallocate(m_allocator, m_storage.m_heap, m_capacity);
+    m_capacity = N;
+    m_size = 0;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::copy_from(const small_flat_set &other)
+{
+    reserve(other.m_size);
+    std::copy(other.begin(), other.end(), mutable_data());
+    m_size = other.m_size;
+}
+
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void small_flat_set<Key, N, Compare, Allocator>::steal_from(small_flat_set &other) noexcept
+{
+    if (other.is_inline())
+    {
+        std::copy(other.begin(), other.end(), m_storage.m_inline);
+        m_capacity = N;
+    }
+    else
+    {
+        m_storage.m_heap = other.m_storage.m_heap;
+        m_capacity = other.m_capacity;
+    }
+    m_size = other.m_size;
+    other.m_capacity = N;
+    other.m_size = 0;
+}
+
+// standalone swap function
+template <typename Key, std::size_t N, typename Compare, typename Allocator>
+void swap(small_flat_set<Key, N, Compare, Allocator> &first, small_flat_set<Key, N, Compare, Allocator> &second) noexcept
+{
+    first.swap(second);
+}
+
+namespace pmr
+{
+    template <typename Key, std::size_t N = 8, typename Compare = std::less<Key>>
+    using small_flat_set = ::small_flat_set<Key, N, Compare, std::pmr::polymorphic_allocator<Key>>;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,310 @@
+#ifndef WEIGHTED_ADJACENCY_HPP
+#define WEIGHTED_ADJACENCY_HPP
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Adjacency list that keeps a property per edge, e.g. a weight, for directed_graph.
+// Keys (the adjacency indices) stay sorted in one array and the properties live in a second
+// array in the same order, so scans over the indices touch no property data and the property
+// of an edge is found at the same position. Iterators yield the keys like a set and give the
+// property of the current edge through property().
+// Unlike std::set, inserting or erasing invalidates iterators into the list.
+template <typename Property, typename Key = std::size_t>
+class weighted_adjacency
+{
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using property_type = Property;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const value_type &;
+    using const_reference = const value_type &;
+
+    // Random access iterator over the keys that also points into the property column.
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key *;
+        using reference = const Key &;
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept { return *m_key; }
+        pointer operator->() const noexcept { return m_key; }
+        reference operator[](difference_type offset) const noexcept { return m_key[offset]; }
+        // The property of the edge this iterator points to.
+        const Property &property() const noexcept { return *m_property; }
+
+        const_iterator &operator++() noexcept { return *this += 1; }
+        const_iterator operator++(int) noexcept;
+        const_iterator &operator--() noexcept { return *this -= 1; }
+        const_iterator operator--(int) noexcept;
+        const_iterator &operator+=(difference_type offset) noexcept;
+        const_iterator &operator-=(difference_type offset) noexcept { return *this += -offset; }
+        friend const_iterator operator+(const_iterator it, difference_type offset) noexcept { return it += offset; }
+        friend const_iterator operator+(difference_type offset, const_iterator it) noexcept { return it += offset; }
+        friend const_iterator operator-(const_iterator it, difference_type offset) noexcept { return it -= offset; }
+        friend difference_type operator-(const const_iterator &lhs, const const_iterator &rhs) noexcept { return lhs.m_key - rhs.m_key; }
+
+        bool operator==(const const_iterator &rhs) const noexcept { return m_key == rhs.m_key; }
+        std::strong_ordering operator<=>(const const_iterator &rhs) const noexcept { return m_key <=> rhs.m_key; }
+
+    private:
+        friend class weighted_adjacency;
+        const_iterator(const Key *key, const Property *property) noexcept : m_key(key), m_property(property) {}
+
+        const Key *m_key = nullptr;
+        const Property *m_property = nullptr;
+    };
+    // keys are immutable through iterators, just like std::set
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    weighted_adjacency() = default;
+
+    const_iterator begin() const noexcept { return iterator_at(0); }
+    const_iterator end() const noexcept { return iterator_at(m_keys.size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    size_type size() const noexcept { return m_keys.size(); }
+    bool empty() const noexcept { return m_keys.empty(); }
+    size_type capacity() const noexcept { return m_keys.capacity(); }
+    size_type max_size() const noexcept { return std::min(m_keys.max_size(), m_properties.max_size()); }
+
+    // New keys get a value-initialized property.
+    std::pair<iterator, bool> insert(const key_type &key) { return insert(key, Property{}); }
+    // Like std::map::insert, an existing key keeps its property.
+    std::pair<iterator, bool> insert(const key_type &key, const Property &property);
+    std::pair<iterator, bool> insert_or_assign(const key_type &key, const Property &property);
+    // hint is only used to append in O(1) when it is end() and key is the largest key
+    iterator insert(const_iterator hint, const key_type &key);
+
+    iterator erase(const_iterator pos);
+    size_type erase(const key_type &key);
+
+    const_iterator find(const key_type &key) const;
+    const_iterator lower_bound(const key_type &key) const;
+    size_type count(const key_type &key) const { return contains(key) ? 1 : 0; }
+    bool contains(const key_type &key) const { return find(key) != end(); }
+
+    // Mutable access to the property of the edge at pos.
+    Property &property(const_iterator pos) noexcept { return m_properties[position_of(pos)]; }
+    const Property &property(const_iterator pos) const noexcept { return pos.property(); }
+
+    void clear() noexcept;
+    void reserve(size_type new_capacity);
+    void shrink_to_fit();
+
+    // Erases removed_key and decrements every larger key, the properties move along.
+    void remove_and_renumber(const key_type &removed_key);
+    // Replaces every key k by remap[k], dropping the keys mapped to key_type(-1).
+    // remap must be monotonic on the kept keys so they stay sorted.
+    template <typename Remap>
+    void remap(const Remap &remap);
+
+    void swap(weighted_adjacency &other) noexcept;
+
+    bool operator==(const weighted_adjacency &rhs) const = default;
+
+private:
+    std::vector<Key> m_keys;
+    std::vector<Property> m_properties;
+
+    const_iterator iterator_at(size_type position) const noexcept { return const_iterator(m_keys.data() + position, m_properties.data() + position); }
+    size_type position_of(const_iterator pos) const noexcept { return static_cast<size_type>(pos.m_key - m_keys.data()); }
+};
+
+// Property type of an adjacency list, no_edge_property for the plain sets of indices.
+struct no_edge_property
+{
+};
+
+template <typename Adjacency>
+struct edge_property_of
+{
+    using type = no_edge_property;
+};
+
+template <typename Adjacency>
+    requires requires { typename Adjacency::property_type; }
+struct edge_property_of<Adjacency>
+{
+    using type = typename Adjacency::property_type;
+};
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::const_iterator weighted_adjacency<Property, Key>::const_iterator::operator++(int) noexcept
+{
+    auto oldIt = *this;
+    ++*this;
+    return oldIt;
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::const_iterator weighted_adjacency<Property, Key>::const_iterator::operator--(int) noexcept
+{
+    auto oldIt = *this;
+    --*this;
+    return oldIt;
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::const_iterator &weighted_adjacency<Property, Key>::const_iterator::operator+=(difference_type offset) noexcept
+{
+    m_key += offset;
+    m_property += offset;
+    return *this;
+}
+
+template <typename Property, typename Key>
+std::pair<typename weighted_adjacency<Property, Key>::iterator, bool> weighted_adjacency<Property, Key>::insert(const key_type &key, const Property &property)
+{
+    const auto pos = std::lower_bound(std::begin(m_keys), std::end(m_keys), key);
+    const auto position = static_cast<size_type>(pos - std::begin(m_keys));
+    if (pos != std::end(m_keys) && *pos == key)
+        return {iterator_at(position), false};
+
+    m_properties.insert(std::begin(m_properties) + static_cast<difference_type>(position), property);
+    try
+    {
+        m_keys.insert(std::begin(m_keys) + static_cast<difference_type>(position), key);
+    }
+    catch (...)
+    {
+        m_properties.erase(std::begin(m_properties) + static_cast<difference_type>(position)); // keep both columns the same length
+        throw;
+    }
+    return {iterator_at(position), true};
+}
+
+template <typename Property, typename Key>
+std::pair<typename weighted_adjacency<Property, Key>::iterator, bool> weighted_adjacency<Property, Key>::insert_or_assign(const key_type &key, const Property &property)
+{
+    auto result = insert(key, property);
+    if (!result.second)
+        m_properties[position_of(result.first)] = property;
+    return result;
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::iterator weighted_adjacency<Property, Key>::insert(const_iterator hint, const key_type &key)
+{
+    if (hint == end() && (m_keys.empty() || m_keys.back() < key))
+    {
+        m_properties.emplace_back();
+        try
+        {
+            m_keys.push_back(key);
+        }
+        catch (...)
+        {
+            m_properties.pop_back();
+            throw;
+        }
+        return iterator_at(m_keys.size() - 1);
+    }
+    return insert(key).first;
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::iterator weighted_adjacency<Property, Key>::erase(const_iterator pos)
+{
+    const auto position = static_cast<difference_type>(position_of(pos));
+    m_keys.erase(std::begin(m_keys) + position);
+    m_properties.erase(std::begin(m_properties) + position);
+    return iterator_at(static_cast<size_type>(position));
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::size_type weighted_adjacency<Property, Key>::erase(const key_type &key)
+{
+    const auto pos = find(key);
+    if (pos == end())
+        return 0;
+    erase(pos);
+    return 1;
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::const_iterator weighted_adjacency<Property, Key>::find(const key_type &key) const
+{
+    const auto pos = lower_bound(key);
+    return pos != end() && *pos == key ? pos : end();
+}
+
+template <typename Property, typename Key>
+typename weighted_adjacency<Property, Key>::const_iterator weighted_adjacency<Property, Key>::lower_bound(const key_type &key) const
+{
+    const auto pos = std::lower_bound(std::begin(m_keys), std::end(m_keys), key);
+    return iterator_at(static_cast<size_type>(pos - std::begin(m_keys)));
+}
+
+template <typename Property, typename Key>
+void weighted_adjacency<Property, Key>::clear() noexcept
+{
+    m_keys.clear();
+    m_properties.clear();
+}
+
+template <typename Property, typename Key>
+void weighted_adjacency<Property, Key>::reserve(size_type new_capacity)
+{
+    m_keys.reserve(new_capacity);
+    m_properties.reserve(new_capacity);
+}
+
+template <typename Property, typename Key>
+void weighted_adjacency<Property, Key>::shrink_to_fit()
+{
+    m_keys.shrink_to_fit();
+    m_properties.shrink_to_fit();
+}
+
+template <typename Property, typename Key>
+void weighted_adjacency<Property, Key>::remove_and_renumber(const key_type &removed_key)
+{
+    erase(removed_key);
+    for (auto pos = std::upper_bound(std::begin(m_keys), std::end(m_keys), removed_key); pos != std::end(m_keys); ++pos)
+        --*pos;
+}
+
+template <typename Property, typename Key>
+template <typename Remap>
+void weighted_adjacency<Property, Key>::remap(const Remap &remap)
+{
+    size_type kept = 0;
+    for (size_type position = 0; position < m_keys.size(); ++position)
+    {
+        const auto key = static_cast<Key>(remap[m_keys[position]]);
+        if (key == static_cast<Key>(-1))
+            continue;
+        m_keys[kept] = key;
+        if (kept != position)
+            m_properties[kept] = std::move(m_properties[position]);
+        ++kept;
+    }
+    m_keys.resize(kept);
+    m_properties.erase(std::begin(m_properties) + static_cast<difference_type>(kept), std::end(m_properties));
+}
+
+template <typename Property, typename Key>
+void weighted_adjacency<Property, Key>::swap(weighted_adjacency &other) noexcept
+{
+    m_keys.swap(other.m_keys);
+    m_properties.swap(other.m_properties);
+}
+#endif
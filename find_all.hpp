@@ -0,0 +1,126 @@
+#ifndef FIND_ALL_HPP
+#define FIND_ALL_HPP
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+// Comparison predicates find_all recognises. On contiguous ranges of arithmetic values they are
+// evaluated a block of 64 elements at a time into a match bitmask, a branch-free loop the compiler
+// turns into SIMD compares; any other predicate goes through the plain loop.
+template <typename T>
+struct equal_to_value
+{
+    using compared_type = T;
+    T value;
+    bool operator()(const T &element) const noexcept { return element == value; }
+};
+
+template <typename T>
+struct less_than_value
+{
+    using compared_type = T;
+    T value;
+    bool operator()(const T &element) const noexcept { return element < value; }
+};
+
+template <typename T>
+struct greater_than_value
+{
+    using compared_type = T;
+    T value;
+    bool operator()(const T &element) const noexcept { return element > value; }
+};
+
+template <typename Iterator, typename Predicate>
+concept vectorizable_search = std::contiguous_iterator<Iterator> && std::is_arithmetic_v<std::iter_value_t<Iterator>> &&
+                              requires { typename Predicate::compared_type; } &&
+                              std::same_as<typename Predicate::compared_type, std::iter_value_t<Iterator>>;
+
+namespace find_all_detail
+{
+    inline constexpr std::size_t block_size = 64;
+
+    // Bit i is set if pred(block[i]), count <= block_size. The compares go to a byte per element
+    // first, that loop vectorizes; every 8 bytes are then packed into 8 bits with one multiply.
+    template <typename T, typename Predicate>
+    std::uint64_t match_mask(const T *block, std::size_t count, Predicate pred) noexcept
+    {
+        std::uint8_t flags[block_size] = {};
+        for (std::size_t index = 0; index < count; ++index)
+            flags[index] = pred(block[index]);
+
+        std::uint64_t mask = 0;
+        for (std::size_t byte = 0; byte < block_size / 8; ++byte)
+        {
+            // flag k goes to bit 8k, the multiply then gathers all eight into bits 56 .. 63
+            std::uint64_t word = 0;
+            if constexpr (std::endian::native == std::endian::little)
+            {
+                std::memcpy(&word, flags + byte * 8, sizeof(word));
+            }
+            else
+            {
+                for (std::size_t k = 0; k < 8; ++k)
+                    word |= static_cast<std::uint64_t>(flags[byte * 8 + k]) << (8 * k);
+            }
+            mask |= ((word * 0x0102040810204080ull) >> 56) << (byte * 8);
+        }
+        return mask;
+    }
+
+    // Writes first + offset + i for every bit i of mask, in order.
+    template <typename Iterator, typename OutputIterator>
+    OutputIterator emit_matches(Iterator first, std::size_t offset, std::uint64_t mask, OutputIterator output)
+    {
+        while (mask != 0)
+        {
+            *output = first + static_cast<std::iter_difference_t<Iterator>>(offset + std::countr_zero(mask));
+            ++output;
+            mask &= mask - 1;
+        }
+        return output;
+    }
+
+    template <typename Iterator, typename OutputIterator, typename Predicate>
+    OutputIterator find_all_vectorized(Iterator first, Iterator last, OutputIterator output, Predicate pred)
+    {
+        const auto *data = std::to_address(first);
+        const auto size = static_cast<std::size_t>(last - first);
+        std::size_t offset = 0;
+        // full blocks have a constant trip count, which is what lets the compiler vectorize them
+        for (; offset + block_size <= size; offset += block_size)
+            output = emit_matches(first, offset, match_mask(data + offset, block_size, pred), output);
+        if (offset != size)
+            output = emit_matches(first, offset, match_mask(data + offset, size - offset, pred), output);
+        return output;
+    }
+}
+
+template <typename InputIterator, typename OutputIterator, typename Predicate>
+OutputIterator find_all(InputIterator first, InputIterator last, OutputIterator output, Predicate pred)
+{
+    if constexpr (vectorizable_search<InputIterator, Predicate>)
+    {
+        return find_all_detail::find_all_vectorized(first, last, output, pred);
+    }
+    else
+    {
+        while (first != last)
+        {
+            if (pred(*first))
+            {
+                *output = first;
+                ++output;
+            }
+            ++first;
+        }
+
+        return output;
+    }
+}
+#endif
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "find_all_parallel.hpp"
+
+// Times the plain loop (a lambda predicate) against the vectorized and parallel paths.
+template <typename Search>
+void time_find_all(std::string_view name, const std::vector<int> &values, Search search)
+{
+    std::vector<std::vector<int>::const_iterator> matches;
+    matches.reserve(values.size() / 50);
+    double best = 0;
+    for (int run = 0; run < 5; ++run)
+    {
+        matches.clear();
+        const auto start = std::chrono::steady_clock::now();
+        search(std::back_inserter(matches));
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || ms < best)
+            best = ms;
+    }
+    std::cout << name << ": " << best << " ms, " << matches.size() << " matches" << std::endl;
+}
+
+void benchmark_find_all(std::size_t size)
+{
+    std::vector<int> values(size);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> distribution(0, 99);
+    std::generate(begin(values), end(values), [&]
+                  { return distribution(rng); });
+
+    const auto loop_predicate = [](int i)
+    { return i == 5; };
+    const equal_to_value<int> simd_predicate{5};
+    time_find_all("loop", values, [&](auto output)
+                  { find_all(cbegin(values), cend(values), output, loop_predicate); });
+    time_find_all("vectorized", values, [&](auto output)
+                  { find_all(cbegin(values), cend(values), output, simd_predicate); });
+    time_find_all("par loop", values, [&](auto output)
+                  { find_all(std::execution::par, cbegin(values), cend(values), output, loop_predicate); });
+    time_find_all("par vectorized", values, [&](auto output)
+                  { find_all(std::execution::par, cbegin(values), cend(values), output, simd_predicate); });
+}
+
+//   g++ -std=c++20 -O3 find_all_benchmark.cpp -o find_all_benchmark -ltbb
+//   ./find_all_benchmark [size], 4M ints by default
+int main(int argc, char *argv[])
+{
+    benchmark_find_all(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef FIND_ALL_PARALLEL_HPP
+#define FIND_ALL_PARALLEL_HPP
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "find_all.hpp"
+
+// The find_all overload taking an execution policy. It lives apart from find_all.hpp because
+// <execution> needs the parallel backend (TBB with libstdc++, link with -ltbb), which the serial
+// find_all does not.
+// Splits the range into chunks searched in parallel, each collecting its matches on its own,
+// then writes the matches to output in range order. seq and unseq run the serial find_all;
+// par_unseq runs the chunks like par since collecting matches allocates.
+template <typename ExecutionPolicy, typename ForwardIterator, typename OutputIterator, typename Predicate>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+OutputIterator find_all(ExecutionPolicy &&, ForwardIterator first, ForwardIterator last, OutputIterator output, Predicate pred)
+{
+    using policy_type = std::remove_cvref_t<ExecutionPolicy>;
+    if constexpr (std::is_same_v<policy_type, std::execution::sequenced_policy> || std::is_same_v<policy_type, std::execution::unsequenced_policy>)
+    {
+        return find_all(first, last, output, pred);
+    }
+    else
+    {
+        // below this many elements per chunk the threads cost more than they save
+        constexpr std::size_t min_chunk_size = 16384;
+        const auto size = static_cast<std::size_t>(std::distance(first, last));
+        const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t chunk_count = std::clamp<std::size_t>(size / min_chunk_size, 1, threads * 4);
+        if (chunk_count == 1)
+            return find_all(first, last, output, pred);
+
+        struct chunk
+        {
+            ForwardIterator m_first;
+            ForwardIterator m_last;
+            std::vector<ForwardIterator> m_matches;
+        };
+        std::vector<chunk> chunks;
+        chunks.reserve(chunk_count);
+        for (std::size_t index = 0; index < chunk_count; ++index)
+        {
+            // spread the remainder over the first chunks
+            const auto length = static_cast<std::iter_difference_t<ForwardIterator>>(size / chunk_count + (index < size % chunk_count ? 1 : 0));
+            const auto chunk_last = std::next(first, length);
+            chunks.push_back({first, chunk_last, {}});
+            first = chunk_last;
+        }
+
+        std::for_each(std::execution::par, std::begin(chunks), std::end(chunks), [&pred](chunk &part)
+                      { find_all(part.m_first, part.m_last, std::back_inserter(part.m_matches), pred); });
+
+        for (const auto &part : chunks)
+            output = std::copy(std::begin(part.m_matches), std::end(part.m_matches), output);
+        return output;
+    }
+}
+#endif